@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CL_SWCACHE_H__
+#define __CL_SWCACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pmsis/cluster/dma/cl_dma.h"
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterSwCache L1 software cache
+ *
+ * This set of functions provides a set-associative cache of external memory
+ * (usually L2) in cluster L1 memory, managed by software, for kernels doing
+ * irregular accesses such as table lookups, where the data to copy with the
+ * cluster DMA is not known in advance.
+ *
+ * Each access gives the external address of the data and gets a pointer to
+ * its copy in L1 memory. On a hit, this only costs a few instructions, which
+ * are inlined in the caller. On a miss, the line is loaded with the cluster
+ * DMA, after the least recently refilled line of the set has been written
+ * back if it was modified. Lines can also be prefetched so that the DMA
+ * transfer overlaps with the computation.
+ *
+ * A cache is not protected against concurrent accesses, so it must be used by
+ * a single core at a time. When the cores of a team do random accesses, each
+ * core should use its own cache. Accesses going through different caches or
+ * directly to the external memory are not kept coherent, which is fine for
+ * read-only data. For modified data, pi_cl_swcache_flush must be called before
+ * the data is read from somewhere else.
+ */
+
+/**
+ * @addtogroup ClusterSwCache
+ * @{
+ */
+
+/**@{*/
+
+/** \struct pi_cl_swcache_conf
+ * \brief Software cache configuration structure.
+ */
+struct pi_cl_swcache_conf
+{
+    void *l1_buffer;        /*!< Buffer in cluster L1 memory holding the lines
+      and the tags, 4 bytes aligned. */
+    uint32_t l1_size;       /*!< Size in bytes of the buffer. The number of
+      lines is the biggest power of 2 fitting in the buffer with its tags. */
+    uint16_t line_size;     /*!< Size in bytes of a line, a power of 2 from 8
+      to 1024. */
+    uint8_t nb_ways;        /*!< Number of lines per set, 1, 2, 4 or 8. */
+    uint8_t write_back;     /*!< 1 if data can be modified through the cache,
+      in which case the modified lines are written back when they are evicted
+      or flushed. 0 for read-only data. */
+};
+
+/** \struct pi_cl_swcache_stats
+ * \brief Software cache statistics.
+ */
+struct pi_cl_swcache_stats
+{
+    uint32_t hits;          /*!< Number of accesses served from L1 memory,
+      including the accesses to prefetched lines. */
+    uint32_t misses;        /*!< Number of accesses which waited for a line
+      refill. */
+    uint32_t prefetches;    /*!< Number of line refills started by
+      pi_cl_swcache_prefetch. */
+    uint32_t prefetch_waits; /*!< Number of accesses which waited for the end
+      of a prefetch. */
+    uint32_t write_backs;   /*!< Number of modified lines written back. */
+};
+
+/** \brief Software cache structure.
+ *
+ * This structure is used by the runtime to manage a cache. It must be kept
+ * alive until the cache is not used anymore, and should be allocated in
+ * cluster L1 memory as it is accessed at each lookup.
+ */
+typedef struct pi_cl_swcache_s pi_cl_swcache_t;
+
+/** \brief Initialize a software cache configuration with default values.
+ *
+ * The default configuration has 64 bytes lines, 2 ways and is read-only. The
+ * buffer must still be set.
+ *
+ * \param conf A pointer to the software cache configuration.
+ */
+void pi_cl_swcache_conf_init(struct pi_cl_swcache_conf *conf);
+
+/** \brief Initialize a software cache.
+ *
+ * All the lines are invalid after initialization.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param conf  A pointer to the software cache configuration. It can be
+ *   released once this function returns.
+ * \return      0 if the operation is successfull, -1 if the configuration is
+ *   invalid or the buffer is too small for one line per way.
+ */
+int pi_cl_swcache_init(pi_cl_swcache_t *cache, struct pi_cl_swcache_conf *conf);
+
+/** \brief Get the L1 copy of external data.
+ *
+ * This returns a pointer to the L1 copy of the data at the specified external
+ * address, loading its line if needed. The data accessed through the pointer
+ * must not cross a line boundary, which is the case for naturally aligned
+ * data smaller than a line. The pointer is only valid until the next access
+ * to the cache, which can evict the line.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param addr  The external address of the data.
+ * \param write 1 if the data will be modified through the pointer, which marks
+ *   the line as dirty. Only allowed for a write-back cache.
+ * \return      The address of the L1 copy.
+ */
+static inline void *pi_cl_swcache_ptr(pi_cl_swcache_t *cache, uint32_t addr,
+  int write);
+
+/** \brief Read a 32 bits value through the cache.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param addr  The external address, 4 bytes aligned.
+ * \return      The value.
+ */
+static inline uint32_t pi_cl_swcache_read32(pi_cl_swcache_t *cache,
+  uint32_t addr)
+{
+    return *(uint32_t *)pi_cl_swcache_ptr(cache, addr, 0);
+}
+
+/** \brief Read a 16 bits value through the cache.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param addr  The external address, 2 bytes aligned.
+ * \return      The value.
+ */
+static inline uint16_t pi_cl_swcache_read16(pi_cl_swcache_t *cache,
+  uint32_t addr)
+{
+    return *(uint16_t *)pi_cl_swcache_ptr(cache, addr, 0);
+}
+
+/** \brief Read an 8 bits value through the cache.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param addr  The external address.
+ * \return      The value.
+ */
+static inline uint8_t pi_cl_swcache_read8(pi_cl_swcache_t *cache,
+  uint32_t addr)
+{
+    return *(uint8_t *)pi_cl_swcache_ptr(cache, addr, 0);
+}
+
+/** \brief Write a 32 bits value through the cache.
+ *
+ * \param cache A pointer to the software cache structure, which must be a
+ *   write-back one.
+ * \param addr  The external address, 4 bytes aligned.
+ * \param value The value.
+ */
+static inline void pi_cl_swcache_write32(pi_cl_swcache_t *cache,
+  uint32_t addr, uint32_t value)
+{
+    *(uint32_t *)pi_cl_swcache_ptr(cache, addr, 1) = value;
+}
+
+/** \brief Prefetch a line.
+ *
+ * This starts loading the line containing the specified address if it is not
+ * already in the cache, and returns without waiting for the transfer. The
+ * next access to this line waits for the end of the transfer if needed.
+ * Prefetching a line evicts another one, so prefetching too far ahead can
+ * lower the hit rate.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param addr  The external address.
+ */
+void pi_cl_swcache_prefetch(pi_cl_swcache_t *cache, uint32_t addr);
+
+/** \brief Write back all the modified lines.
+ *
+ * The lines stay valid. The caller is blocked until all the transfers are
+ * finished.
+ *
+ * \param cache A pointer to the software cache structure.
+ */
+void pi_cl_swcache_flush(pi_cl_swcache_t *cache);
+
+/** \brief Invalidate all the lines.
+ *
+ * Modified lines are lost, so pi_cl_swcache_flush must be called before if
+ * they must be kept. This must be called when the external data has been
+ * modified by someone else.
+ *
+ * \param cache A pointer to the software cache structure.
+ */
+void pi_cl_swcache_invalidate(pi_cl_swcache_t *cache);
+
+/** \brief Get the statistics of a software cache.
+ *
+ * \param cache A pointer to the software cache structure.
+ * \param stats A pointer to the structure where the statistics are stored.
+ * \param reset 1 to reset the statistics after they are read.
+ */
+void pi_cl_swcache_stats_get(pi_cl_swcache_t *cache,
+  struct pi_cl_swcache_stats *stats, int reset);
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+
+/// @cond IMPLEM
+
+// Lines are aligned on at least 8 bytes, so the low bits of the tags are free
+#define __PI_CL_SWCACHE_TAG_VALID   (1 << 0)
+#define __PI_CL_SWCACHE_TAG_DIRTY   (1 << 1)
+#define __PI_CL_SWCACHE_TAG_PENDING (1 << 2)
+
+struct pi_cl_swcache_s
+{
+    uint32_t *tags;
+    uint8_t *data;
+    uint32_t line_mask;
+    uint32_t set_mask;
+    uint8_t line_shift;
+    uint8_t ways_shift;
+    uint8_t write_back;
+    uint8_t *victims;
+    pi_cl_dma_copy_t copy;
+    struct pi_cl_swcache_stats stats;
+};
+
+// Slow path, handling misses and lines being prefetched
+void *__pi_cl_swcache_miss(pi_cl_swcache_t *cache, uint32_t addr, int write);
+
+static inline void *pi_cl_swcache_ptr(pi_cl_swcache_t *cache, uint32_t addr,
+  int write)
+{
+    uint32_t offset = addr & cache->line_mask;
+    uint32_t line = addr - offset;
+    uint32_t index = ((line >> cache->line_shift) & cache->set_mask) << cache->ways_shift;
+    uint32_t *tags = &cache->tags[index];
+
+    for (int way = 0; way < (1 << cache->ways_shift); way++)
+    {
+        // Lines being prefetched do not match and go through the slow path
+        if ((tags[way] & ~__PI_CL_SWCACHE_TAG_DIRTY) == (line | __PI_CL_SWCACHE_TAG_VALID))
+        {
+            cache->stats.hits++;
+            if (write)
+            {
+                tags[way] |= __PI_CL_SWCACHE_TAG_DIRTY;
+            }
+            return &cache->data[((index + way) << cache->line_shift) + offset];
+        }
+    }
+
+    return __pi_cl_swcache_miss(cache, addr, write);
+}
+
+/// @endcond
+
+#endif  /* __CL_SWCACHE_H__ */
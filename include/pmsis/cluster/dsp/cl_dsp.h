@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_CLUSTER_DSP_CL_DSP_H__
+#define __PMSIS_CLUSTER_DSP_CL_DSP_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterDSP DSP kernels
+ *
+ * This set of functions provides common signal processing kernels running on
+ * the cluster: FIR filter, complex and real FFT, matrix multiplication, dot
+ * products and 8 bits 2D convolution.
+ *
+ * The kernels work on fixed-point data: Q15 for 16 bits samples and signed 8
+ * bits for quantized tensors, with 32 bits accumulation. They must be called
+ * from the cluster controller core, outside of any team fork, as they fork on
+ * the requested number of cores and split the output between them. The
+ * caller is blocked until the whole output is produced. All buffers should be
+ * in cluster L1 memory to get the best performance.
+ *
+ * On chips with packed-SIMD extensions, the kernels process 2 Q15 or 4 8 bits
+ * values per instruction, with sum-of-dot-product instructions, so the 8 bits
+ * kernels are about twice as fast as the Q15 ones for the same number of
+ * MACs. Lengths and sizes which are multiples of 2 (Q15) or 4 (8 bits) avoid
+ * the scalar processing of the remaining elements.
+ */
+
+/**
+ * @addtogroup ClusterDSP
+ * @{
+ */
+
+/**@{*/
+
+/** \struct pi_cl_dsp_fft
+ * \brief Complex FFT descriptor.
+ *
+ * This contains the precomputed tables of an FFT size, which can be shared
+ * by several FFTs of the same size.
+ */
+struct pi_cl_dsp_fft
+{
+    uint16_t nb_points;     /*!< Number of complex points. */
+    uint8_t radix;          /*!< 4 if the number of points is a power of 4,
+      otherwise 2. */
+    const int16_t *twiddles; /*!< Twiddle factors, in Q15, interleaved real
+      and imaginary parts. */
+    const uint16_t *swap_table; /*!< Bit or digit reversal permutation. */
+};
+
+/** \struct pi_cl_dsp_rfft
+ * \brief Real FFT descriptor.
+ *
+ * A real FFT of N points is computed with a complex FFT of N/2 points followed
+ * by a split step, so it contains the descriptor of this complex FFT.
+ */
+struct pi_cl_dsp_rfft
+{
+    uint16_t nb_points;     /*!< Number of real points. */
+    struct pi_cl_dsp_fft fft; /*!< Complex FFT of nb_points / 2 points. */
+    const int16_t *split_twiddles; /*!< Twiddle factors of the split step, in
+      Q15, interleaved real and imaginary parts. */
+};
+
+/** \struct pi_cl_dsp_conv_conf
+ * \brief 8 bits 2D convolution parameters.
+ *
+ * Tensors are in HWC layout, weights are in [out_c][kernel_h][kernel_w][in_c]
+ * layout. Each output value is computed with a 32 bits accumulator and a 64
+ * bits requantization product, rounded to the nearest value, halves being
+ * rounded up:
+ *
+ *     acc = bias[oc] + sum(in * weights)
+ *     out = clip_s8(((int64_t)acc * out_scale + round) >> out_shift)
+ *
+ * with round = 1 << (out_shift - 1), or 0 if out_shift is 0, and an
+ * arithmetic right shift. With relu, negative values are then clipped to 0.
+ */
+struct pi_cl_dsp_conv_conf
+{
+    uint16_t in_w;          /*!< Input width. */
+    uint16_t in_h;          /*!< Input height. */
+    uint16_t in_c;          /*!< Number of input channels. */
+    uint16_t out_c;         /*!< Number of output channels. */
+    uint8_t kernel_w;       /*!< Kernel width. */
+    uint8_t kernel_h;       /*!< Kernel height. */
+    uint8_t stride;         /*!< Stride in both directions. */
+    uint8_t pad;            /*!< Zero padding on each side in both
+      directions. */
+    int32_t out_scale;      /*!< Requantization multiplier. */
+    uint8_t out_shift;      /*!< Requantization right shift. */
+    uint8_t relu;           /*!< 1 to clip negative output values to 0. */
+};
+
+/** \brief FIR filter on Q15 samples.
+ *
+ * This computes each output sample as the dot product of the coefficients and
+ * the last nb_taps input samples, with a 32 bits accumulator shifted right by
+ * shift and saturated to 16 bits. The input must contain nb_taps - 1 history
+ * samples followed by the nb_samples new samples, so consecutive blocks are
+ * processed by copying the last nb_taps - 1 input samples at the beginning of
+ * the next input.
+ *
+ * \param in         Input samples, nb_samples + nb_taps - 1 samples.
+ * \param out        Output samples, nb_samples samples.
+ * \param coeffs     Coefficients, in Q15, in reversed order, i.e. the first
+ *   one is applied to the oldest sample.
+ * \param nb_taps    Number of coefficients. Must be even to allow packed-SIMD
+ *   processing.
+ * \param nb_samples Number of output samples.
+ * \param shift      Right shift applied to the accumulator, usually 15.
+ * \param nb_cores   Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ */
+void pi_cl_dsp_fir_q15(const int16_t *in, int16_t *out, const int16_t *coeffs,
+  int nb_taps, int nb_samples, int shift, int nb_cores);
+
+/** \brief Return the size of the FFT tables.
+ *
+ * \param nb_points Number of complex points, a power of 2 from 16 to 4096.
+ * \return          The size in bytes of the tables given to
+ *   pi_cl_dsp_fft_init, or 0 if the size is not supported.
+ */
+size_t pi_cl_dsp_fft_tables_size(int nb_points);
+
+/** \brief Initialize an FFT descriptor.
+ *
+ * This computes the twiddle factors and the reversal permutation in the
+ * tables buffer. It can be called either from fabric-controller or cluster
+ * side, and the tables can then be copied to cluster L1 memory.
+ *
+ * \param fft       A pointer to the FFT descriptor.
+ * \param nb_points Number of complex points, a power of 2 from 16 to 4096.
+ * \param tables    Buffer of pi_cl_dsp_fft_tables_size bytes, 4 bytes
+ *   aligned, which must be kept alive until the descriptor is not used
+ *   anymore.
+ * \return          0 if the operation is successfull, -1 if the size is not
+ *   supported.
+ */
+int pi_cl_dsp_fft_init(struct pi_cl_dsp_fft *fft, int nb_points, void *tables);
+
+/** \brief In-place complex FFT on Q15 samples.
+ *
+ * This uses a radix-4 decimation in frequency when the number of points is a
+ * power of 4, otherwise a radix-2 one. The output is divided by the number of
+ * points to avoid any overflow, each butterfly stage shifting its output, and
+ * is produced in natural order. The butterflies of each stage are
+ * distributed over the cores.
+ *
+ * \param fft       A pointer to the FFT descriptor.
+ * \param data      The complex samples, interleaved real and imaginary parts
+ *   in Q15. It must be 4 bytes aligned.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ */
+void pi_cl_dsp_fft_q15(struct pi_cl_dsp_fft *fft, int16_t *data, int nb_cores);
+
+/** \brief Inverse complex FFT on Q15 samples.
+ *
+ * This is the same as pi_cl_dsp_fft_q15 with conjugated twiddle factors. The
+ * output is not scaled, so that an FFT followed by an inverse FFT gives back
+ * the input with the rounding error of the FFT.
+ *
+ * \param fft       A pointer to the FFT descriptor.
+ * \param data      The complex samples, interleaved real and imaginary parts
+ *   in Q15. It must be 4 bytes aligned.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ */
+void pi_cl_dsp_ifft_q15(struct pi_cl_dsp_fft *fft, int16_t *data, int nb_cores);
+
+/** \brief Return the size of the real FFT tables.
+ *
+ * \param nb_points Number of real points, a power of 2 from 32 to 8192.
+ * \return          The size in bytes of the tables given to
+ *   pi_cl_dsp_rfft_init, or 0 if the size is not supported.
+ */
+size_t pi_cl_dsp_rfft_tables_size(int nb_points);
+
+/** \brief Initialize a real FFT descriptor.
+ *
+ * \param rfft      A pointer to the real FFT descriptor.
+ * \param nb_points Number of real points, a power of 2 from 32 to 8192.
+ * \param tables    Buffer of pi_cl_dsp_rfft_tables_size bytes, 4 bytes
+ *   aligned, which must be kept alive until the descriptor is not used
+ *   anymore.
+ * \return          0 if the operation is successfull, -1 if the size is not
+ *   supported.
+ */
+int pi_cl_dsp_rfft_init(struct pi_cl_dsp_rfft *rfft, int nb_points,
+  void *tables);
+
+/** \brief Real-input FFT on Q15 samples.
+ *
+ * This computes the first nb_points / 2 + 1 bins of the FFT of a real signal,
+ * the other ones being their complex conjugates. As for pi_cl_dsp_fft_q15,
+ * the output is divided by the number of points.
+ *
+ * \param rfft      A pointer to the real FFT descriptor.
+ * \param in        The real samples, in Q15. It must be 4 bytes aligned. It is
+ *   used as work buffer and is modified.
+ * \param out       The output bins, nb_points / 2 + 1 complex values with
+ *   interleaved real and imaginary parts in Q15. It must be 4 bytes aligned.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ */
+void pi_cl_dsp_rfft_q15(struct pi_cl_dsp_rfft *rfft, int16_t *in, int16_t *out,
+  int nb_cores);
+
+/** \brief Q15 matrix multiplication.
+ *
+ * This computes out = (a * b) >> shift, saturated to 16 bits, with a 32 bits
+ * accumulator. Matrices are stored row-major. The rows of the output are
+ * distributed over the cores.
+ *
+ * \param a         Left matrix, m x k.
+ * \param b         Right matrix, k x n, stored transposed, i.e. n rows of k
+ *   elements, so that both operands are read contiguously.
+ * \param out       Output matrix, m x n.
+ * \param m         Number of rows of a.
+ * \param n         Number of columns of b.
+ * \param k         Number of columns of a and rows of b. Must be even to allow
+ *   packed-SIMD processing.
+ * \param shift     Right shift applied to the accumulator.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ */
+void pi_cl_dsp_matmul_q15(const int16_t *a, const int16_t *b, int16_t *out,
+  int m, int n, int k, int shift, int nb_cores);
+
+/** \brief Signed 8 bits matrix multiplication with 32 bits output.
+ *
+ * This computes out = a * b without any scaling. Matrices are stored
+ * row-major. The rows of the output are distributed over the cores.
+ *
+ * \param a         Left matrix, m x k.
+ * \param b         Right matrix, k x n, stored transposed, i.e. n rows of k
+ *   elements.
+ * \param out       Output matrix, m x n.
+ * \param m         Number of rows of a.
+ * \param n         Number of columns of b.
+ * \param k         Number of columns of a and rows of b. Must be a multiple of
+ *   4 to allow packed-SIMD processing.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ */
+void pi_cl_dsp_matmul_s8(const int8_t *a, const int8_t *b, int32_t *out,
+  int m, int n, int k, int nb_cores);
+
+/** \brief Q15 dot product.
+ *
+ * The vector is split into one chunk per core and the partial sums are added
+ * by the cluster controller core.
+ *
+ * \param a         First vector.
+ * \param b         Second vector.
+ * \param size      Number of elements. Must be even to allow packed-SIMD
+ *   processing.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          The 32 bits sum of the products, which wraps around in case
+ *   of overflow.
+ */
+int32_t pi_cl_dsp_dot_q15(const int16_t *a, const int16_t *b, int size,
+  int nb_cores);
+
+/** \brief Signed 8 bits dot product.
+ *
+ * The vector is split into one chunk per core and the partial sums are added
+ * by the cluster controller core.
+ *
+ * \param a         First vector.
+ * \param b         Second vector.
+ * \param size      Number of elements. Must be a multiple of 4 to allow
+ *   packed-SIMD processing.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          The 32 bits sum of the products.
+ */
+int32_t pi_cl_dsp_dot_s8(const int8_t *a, const int8_t *b, int size,
+  int nb_cores);
+
+/** \brief Return the output dimensions of an 8 bits 2D convolution.
+ *
+ * Both dimensions are 0 if the parameters are invalid, i.e. if the stride is
+ * 0 or if the kernel is bigger than the padded input.
+ *
+ * \param conf      A pointer to the convolution parameters.
+ * \param out_w     Where the output width is stored.
+ * \param out_h     Where the output height is stored.
+ */
+static inline void pi_cl_dsp_conv2d_out_size(struct pi_cl_dsp_conv_conf *conf,
+  int *out_w, int *out_h)
+{
+    int padded_w = conf->in_w + 2 * conf->pad;
+    int padded_h = conf->in_h + 2 * conf->pad;
+
+    if (conf->stride == 0 || conf->kernel_w > padded_w || conf->kernel_h > padded_h)
+    {
+        *out_w = 0;
+        *out_h = 0;
+        return;
+    }
+
+    *out_w = (padded_w - conf->kernel_w) / conf->stride + 1;
+    *out_h = (padded_h - conf->kernel_h) / conf->stride + 1;
+}
+
+/** \brief Signed 8 bits 2D convolution.
+ *
+ * The output lines are distributed over the cores. The number of input
+ * channels should be a multiple of 4 to get the packed-SIMD performance, other
+ * values being supported with a slower path for the remaining channels.
+ *
+ * \param conf      A pointer to the convolution parameters.
+ * \param in        Input tensor, in_h x in_w x in_c.
+ * \param weights   Weights, out_c x kernel_h x kernel_w x in_c.
+ * \param bias      Bias, out_c values, or NULL.
+ * \param out       Output tensor, out_h x out_w x out_c, see
+ *   pi_cl_dsp_conv2d_out_size.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          0 if the operation is successfull, -1 if the parameters
+ *   are invalid.
+ */
+int pi_cl_dsp_conv2d_s8(struct pi_cl_dsp_conv_conf *conf, const int8_t *in,
+  const int8_t *weights, const int32_t *bias, int8_t *out, int nb_cores);
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif  /* __PMSIS_CLUSTER_DSP_CL_DSP_H__ */
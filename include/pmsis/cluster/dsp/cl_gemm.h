@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_CLUSTER_DSP_CL_GEMM_H__
+#define __PMSIS_CLUSTER_DSP_CL_GEMM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pmsis/cluster/dsp/cl_dsp.h"
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterGEMM Int8 GEMM engine
+ *
+ * This set of functions provides signed 8 bits matrix multiplication and 2D
+ * convolution on operands bigger than the cluster L1 memory.
+ *
+ * The operands stay in L2 memory and are processed in tiles: the engine
+ * splits the L1 work buffer given by the caller into 2 sets of tile buffers,
+ * and transfers the next tiles with pi_cl_dma_memcpy_2d while the cores
+ * compute on the current ones. The output tiles are sent back the same way.
+ * The tile sizes are chosen to fit the work buffer while maximizing the
+ * reuse of the operands, and can be inspected with pi_cl_gemm_plan.
+ *
+ * Inside a tile, the output rows are distributed over the cores of the team,
+ * and the dot products use the packed-SIMD sum-of-dot-product instructions,
+ * processing 4 MACs per instruction. The sums are accumulated on 32 bits and
+ * requantized to 8 bits with a 64 bits intermediate product, rounded to the
+ * nearest value, halves being rounded up:
+ *
+ *     acc = bias[col] + sum(a * b)
+ *     out = clip_s8(((int64_t)acc * out_scale + round) >> out_shift)
+ *
+ * with round = 1 << (out_shift - 1), or 0 if out_shift is 0, and an
+ * arithmetic right shift. With relu, negative values are then clipped to 0.
+ *
+ * pi_cl_gemm_s8_ref and pi_cl_gemm_conv2d_s8_ref compute the same output
+ * directly on the operands, on the calling core only, without tiling nor DMA.
+ * As the requantization is fully specified, their output must be identical
+ * to the engine one, which can be used to check a tiling plan on small
+ * problems.
+ */
+
+/**
+ * @addtogroup ClusterGEMM
+ * @{
+ */
+
+/**@{*/
+
+/** \struct pi_cl_gemm_conf
+ * \brief GEMM engine configuration structure.
+ */
+struct pi_cl_gemm_conf
+{
+    void *l1_buffer;        /*!< Work buffer in cluster L1 memory, 4 bytes
+      aligned. */
+    uint32_t l1_size;       /*!< Size in bytes of the work buffer. */
+    int32_t out_scale;      /*!< Requantization multiplier, applied with a 64
+      bits product. */
+    uint8_t out_shift;      /*!< Requantization right shift, from 0 to 63,
+      with rounding to nearest. */
+    uint8_t relu;           /*!< 1 to clip negative output values to 0. */
+    int nb_cores;           /*!< Number of cores to use. If it is zero, the
+      number of cores of the previous fork is used. */
+};
+
+/** \struct pi_cl_gemm_plan
+ * \brief Tiling plan.
+ *
+ * This describes how the operands are tiled for a given problem size and
+ * work buffer size.
+ */
+struct pi_cl_gemm_plan
+{
+    uint16_t tile_m;        /*!< Number of rows of a and out per tile. For a
+      convolution, number of output lines per tile. */
+    uint16_t tile_n;        /*!< Number of columns of b and out per tile. For a
+      convolution, number of output channels per tile. */
+    uint16_t tile_k;        /*!< Number of columns of a and rows of b per tile,
+      i.e. the depth of the dot products computed before the accumulators are
+      stored. */
+    uint16_t nb_tiles;      /*!< Total number of tiles. */
+    uint32_t l1_size;       /*!< Size in bytes of the work buffer actually
+      used, including the double buffering. */
+};
+
+/** \struct pi_cl_gemm_stats
+ * \brief Execution statistics.
+ */
+struct pi_cl_gemm_stats
+{
+    uint64_t macs;          /*!< Number of multiply-accumulates. */
+    uint32_t cycles;        /*!< Cycles from the call to the return. */
+    uint32_t dma_wait_cycles; /*!< Cycles the cores waited for DMA transfers,
+      i.e. when the computation of a tile was faster than the transfer of the
+      next one. */
+    uint32_t l2_bytes;      /*!< Number of bytes transferred between L2 and
+      L1. */
+};
+
+/** \brief Initialize a GEMM engine configuration with default values.
+ *
+ * The default configuration has no work buffer, an identity requantization
+ * and uses the number of cores of the previous fork.
+ *
+ * \param conf A pointer to the GEMM engine configuration.
+ */
+void pi_cl_gemm_conf_init(struct pi_cl_gemm_conf *conf);
+
+/** \brief Compute the tiling plan of a matrix multiplication.
+ *
+ * \param conf A pointer to the GEMM engine configuration.
+ * \param m    Number of rows of a.
+ * \param n    Number of columns of b.
+ * \param k    Number of columns of a and rows of b.
+ * \param plan A pointer to the structure where the plan is stored.
+ * \return     0 if the operation is successfull, -1 if the work buffer is too
+ *   small for the smallest tiles.
+ */
+int pi_cl_gemm_plan(struct pi_cl_gemm_conf *conf, int m, int n, int k,
+  struct pi_cl_gemm_plan *plan);
+
+/** \brief Compute the tiling plan of a 2D convolution.
+ *
+ * \param conf A pointer to the GEMM engine configuration.
+ * \param conv A pointer to the convolution parameters.
+ * \param plan A pointer to the structure where the plan is stored.
+ * \return     0 if the operation is successfull, -1 if the work buffer is too
+ *   small for the smallest tiles.
+ */
+int pi_cl_gemm_conv2d_plan(struct pi_cl_gemm_conf *conf,
+  struct pi_cl_dsp_conv_conf *conv, struct pi_cl_gemm_plan *plan);
+
+/** \brief Signed 8 bits matrix multiplication with requantization.
+ *
+ * This computes out = requant(a * b + bias), with the operands in L2 memory.
+ * Matrices are stored row-major.
+ * This must be called from the cluster controller core, outside of any team
+ * fork. The caller is blocked until the whole output is in L2 memory.
+ *
+ * \param conf  A pointer to the GEMM engine configuration.
+ * \param a     Left matrix, m x k.
+ * \param b     Right matrix, k x n, stored transposed, i.e. n rows of k
+ *   elements, so that both operands are read contiguously.
+ * \param bias  Bias, n values, or NULL.
+ * \param out   Output matrix, m x n.
+ * \param m     Number of rows of a.
+ * \param n     Number of columns of b.
+ * \param k     Number of columns of a and rows of b. Must be a multiple of 4.
+ * \param stats A pointer to the structure where the statistics are stored, or
+ *   NULL.
+ * \return      0 if the operation is successfull, -1 if the work buffer is too
+ *   small.
+ */
+int pi_cl_gemm_s8(struct pi_cl_gemm_conf *conf, const int8_t *a,
+  const int8_t *b, const int32_t *bias, int8_t *out, int m, int n, int k,
+  struct pi_cl_gemm_stats *stats);
+
+/** \brief Signed 8 bits 2D convolution with requantization.
+ *
+ * This computes the same convolution as pi_cl_dsp_conv2d_s8, with the
+ * tensors in L2 memory. The input lines needed by each tile, including the
+ * lines overlapping with the next tile, are transferred with 2D DMA copies.
+ * The requantization parameters of the convolution parameters are used
+ * instead of the ones of the engine configuration.
+ * This must be called from the cluster controller core, outside of any team
+ * fork. The caller is blocked until the whole output is in L2 memory.
+ *
+ * \param conf    A pointer to the GEMM engine configuration.
+ * \param conv    A pointer to the convolution parameters.
+ * \param in      Input tensor, in_h x in_w x in_c.
+ * \param weights Weights, out_c x kernel_h x kernel_w x in_c.
+ * \param bias    Bias, out_c values, or NULL.
+ * \param out     Output tensor, out_h x out_w x out_c.
+ * \param stats   A pointer to the structure where the statistics are stored,
+ *   or NULL.
+ * \return        0 if the operation is successfull, -1 if the work buffer is
+ *   too small or the parameters are invalid.
+ */
+int pi_cl_gemm_conv2d_s8(struct pi_cl_gemm_conf *conf,
+  struct pi_cl_dsp_conv_conf *conv, const int8_t *in, const int8_t *weights,
+  const int32_t *bias, int8_t *out, struct pi_cl_gemm_stats *stats);
+
+/** \brief Signed 8 bits matrix multiplication, reference implementation.
+ *
+ * This is the generic C implementation of pi_cl_gemm_s8, running on the
+ * calling core only, directly on the operands. Its output is bit-exact with
+ * pi_cl_gemm_s8. The work buffer of the configuration is not used.
+ *
+ * \param conf  A pointer to the GEMM engine configuration.
+ * \param a     Left matrix, m x k.
+ * \param b     Right matrix, stored transposed.
+ * \param bias  Bias, n values, or NULL.
+ * \param out   Output matrix, m x n.
+ * \param m     Number of rows of a.
+ * \param n     Number of columns of b.
+ * \param k     Number of columns of a and rows of b.
+ */
+void pi_cl_gemm_s8_ref(struct pi_cl_gemm_conf *conf, const int8_t *a,
+  const int8_t *b, const int32_t *bias, int8_t *out, int m, int n, int k);
+
+/** \brief Signed 8 bits 2D convolution, reference implementation.
+ *
+ * This is the generic C implementation of pi_cl_gemm_conv2d_s8, running on
+ * the calling core only, directly on the tensors. Its output is bit-exact with
+ * pi_cl_gemm_conv2d_s8.
+ *
+ * \param conv    A pointer to the convolution parameters.
+ * \param in      Input tensor, in_h x in_w x in_c.
+ * \param weights Weights, out_c x kernel_h x kernel_w x in_c.
+ * \param bias    Bias, out_c values, or NULL.
+ * \param out     Output tensor, out_h x out_w x out_c.
+ * \return        0 if the operation is successfull, -1 if the parameters are
+ *   invalid.
+ */
+int pi_cl_gemm_conv2d_s8_ref(struct pi_cl_dsp_conv_conf *conv,
+  const int8_t *in, const int8_t *weights, const int32_t *bias, int8_t *out);
+
+/** \brief Return the throughput of an execution.
+ *
+ * \param stats A pointer to the execution statistics.
+ * \return      The number of MACs per cycle, in Q8.
+ */
+static inline uint32_t pi_cl_gemm_macs_per_cycle(struct pi_cl_gemm_stats *stats)
+{
+    if (stats->cycles == 0)
+        return 0;
+
+    return (uint32_t)((stats->macs << 8) / stats->cycles);
+}
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif  /* __PMSIS_CLUSTER_DSP_CL_GEMM_H__ */
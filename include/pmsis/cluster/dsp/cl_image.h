@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_CLUSTER_DSP_CL_IMAGE_H__
+#define __PMSIS_CLUSTER_DSP_CL_IMAGE_H__
+
+#include <stdint.h>
+#include "pmsis/drivers/cpi.h"
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterImage Image pre-processing
+ *
+ * This set of functions provides image pre-processing kernels running on the
+ * cluster, typically used between a CPI capture and a neural network:
+ * format conversion, crop, bilinear resize, Bayer demosaicing and
+ * normalization to signed 8 bits.
+ *
+ * The kernels directly accept the buffers produced by the CPI interface,
+ * whole frames or strips. They must be called from the cluster controller
+ * core, outside of any team fork, as they fork on the requested number of
+ * cores and split the output lines between them. The caller is blocked until
+ * the whole output is produced.
+ * Images can be located in any memory accessible from the cluster, but the
+ * kernels are only efficient on images in cluster L1 memory. Bigger images
+ * should be processed in strips copied with the cluster DMA.
+ *
+ * On chips with packed-SIMD extensions, the kernels process 2 or 4 pixels per
+ * instruction. Chaining several kernels on the same strip while it is in L1
+ * memory avoids copying the intermediate images back to L2 memory.
+ */
+
+/**
+ * @addtogroup ClusterImage
+ * @{
+ */
+
+/**@{*/
+
+/** \enum pi_cl_img_format_e
+ * \brief Image format identifier.
+ *
+ * The first formats have the same values as the CPI ones, so that a CPI
+ * format can be used directly as an image format.
+ */
+typedef enum {
+  PI_CL_IMG_FORMAT_RGB565        = PI_CPI_FORMAT_RGB565, /*!< RGB565, 2 bytes
+    per pixel. */
+  PI_CL_IMG_FORMAT_RGB555        = PI_CPI_FORMAT_RGB555, /*!< RGB555, 2 bytes
+    per pixel. */
+  PI_CL_IMG_FORMAT_RGB444        = PI_CPI_FORMAT_RGB444, /*!< RGB444, 2 bytes
+    per pixel. */
+  PI_CL_IMG_FORMAT_YUV422        = PI_CPI_FORMAT_YUV422, /*!< YUYV, 4 bytes
+    per 2 pixels. */
+  PI_CL_IMG_FORMAT_GRAY8         = 0x10, /*!< 8 bits grayscale, which is also
+    the output of the CPI bypass modes and of the CPI filter. */
+  PI_CL_IMG_FORMAT_RGB888        = 0x11, /*!< 8 bits per channel, interleaved
+    (HWC). */
+  PI_CL_IMG_FORMAT_RGB888_PLANAR = 0x12, /*!< 8 bits per channel, one plane
+    per channel (CHW). */
+  PI_CL_IMG_FORMAT_BAYER_RGGB    = 0x20, /*!< 8 bits Bayer raw, RGGB
+    pattern. */
+  PI_CL_IMG_FORMAT_BAYER_BGGR    = 0x21, /*!< 8 bits Bayer raw, BGGR
+    pattern. */
+  PI_CL_IMG_FORMAT_BAYER_GRBG    = 0x22, /*!< 8 bits Bayer raw, GRBG
+    pattern. */
+  PI_CL_IMG_FORMAT_BAYER_GBRG    = 0x23  /*!< 8 bits Bayer raw, GBRG
+    pattern. */
+} pi_cl_img_format_e;
+
+/** \struct pi_cl_img
+ * \brief Image descriptor.
+ *
+ * This structure describes an image buffer. It does not own the buffer and
+ * several descriptors can refer to the same buffer, for example to describe
+ * a window of an image.
+ */
+struct pi_cl_img
+{
+    void *data;                 /*!< Address of the first pixel. */
+    uint16_t width;             /*!< Width in pixels. */
+    uint16_t height;            /*!< Height in pixels. */
+    uint32_t stride;            /*!< Number of bytes between the beginning of
+      2 consecutive lines. For planar formats, the planes are contiguous and
+      each one has height lines. */
+    pi_cl_img_format_e format;  /*!< Pixel format. */
+};
+
+/** \struct pi_cl_img_norm
+ * \brief Normalization parameters.
+ *
+ * Each output value is computed from the 8 bits input channel value as:
+ *
+ *     out = clip_s8(((in - offset[c]) * scale[c]) >> shift)
+ */
+struct pi_cl_img_norm
+{
+    int16_t offset[3];  /*!< Per-channel offset, e.g. the channel mean. */
+    int16_t scale[3];   /*!< Per-channel fixed-point scale, e.g. the inverse
+      of the channel standard deviation. */
+    uint8_t shift;      /*!< Right shift applied after scaling. */
+    uint8_t planar;     /*!< 1 to produce one plane per channel (CHW), 0 to
+      keep the channels interleaved (HWC). */
+};
+
+/** \brief Initialize an image descriptor.
+ *
+ * The stride is set for a packed image, without any padding between lines.
+ *
+ * \param img     A pointer to the image descriptor.
+ * \param data    Address of the first pixel.
+ * \param width   Width in pixels.
+ * \param height  Height in pixels.
+ * \param format  Pixel format.
+ */
+void pi_cl_img_init(struct pi_cl_img *img, void *data, uint16_t width,
+  uint16_t height, pi_cl_img_format_e format);
+
+/** \brief Describe a window of an image.
+ *
+ * This initializes an image descriptor pointing to a rectangle of another
+ * image, without copying any pixel. The result can be given as source to any
+ * kernel, which is how cropping is done. Giving it to pi_cl_img_convert with
+ * a destination of the same format produces a packed copy of the window.
+ * For YUV422 and Bayer formats, x and y must be even.
+ *
+ * \param window  A pointer to the image descriptor of the window.
+ * \param img     A pointer to the image descriptor of the full image.
+ * \param x       x position of the window.
+ * \param y       y position of the window.
+ * \param width   Width of the window.
+ * \param height  Height of the window.
+ * \return        0 if it succeeded or -1 if the window is out of the image.
+ */
+int pi_cl_img_window(struct pi_cl_img *window, struct pi_cl_img *img,
+  uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+/** \brief Convert the pixel format of an image.
+ *
+ * The source and destination must have the same dimensions. Conversions to
+ * GRAY8 use the ITU-R BT.601 luma coefficients. Bayer formats can only be
+ * converted with pi_cl_img_demosaic.
+ *
+ * \param src       A pointer to the source image descriptor.
+ * \param dst       A pointer to the destination image descriptor.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          0 if it succeeded or -1 if the conversion is not supported.
+ */
+int pi_cl_img_convert(struct pi_cl_img *src, struct pi_cl_img *dst,
+  int nb_cores);
+
+/** \brief Resize an image with bilinear interpolation.
+ *
+ * The scaling factors are deduced from the dimensions of the source and
+ * destination images, which must have the same format. Only GRAY8, RGB888
+ * and RGB888_PLANAR are supported. Interpolation weights are computed in Q8.
+ *
+ * \param src       A pointer to the source image descriptor.
+ * \param dst       A pointer to the destination image descriptor.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          0 if it succeeded or -1 if the format is not supported.
+ */
+int pi_cl_img_resize_bilinear(struct pi_cl_img *src, struct pi_cl_img *dst,
+  int nb_cores);
+
+/** \brief Demosaic a Bayer raw image.
+ *
+ * This interpolates the missing channels of each pixel with a bilinear
+ * filter. The destination must be RGB888 or RGB888_PLANAR and have the same
+ * dimensions as the source.
+ *
+ * \param src       A pointer to the source image descriptor.
+ * \param dst       A pointer to the destination image descriptor.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          0 if it succeeded or -1 if the format is not supported.
+ */
+int pi_cl_img_demosaic(struct pi_cl_img *src, struct pi_cl_img *dst,
+  int nb_cores);
+
+/** \brief Normalize an image to signed 8 bits.
+ *
+ * This produces the signed 8 bits tensor expected by quantized networks. The
+ * source can be GRAY8, RGB888 or any of the CPI RGB formats, in which case
+ * the conversion to RGB888 is done on the fly.
+ *
+ * \param src       A pointer to the source image descriptor.
+ * \param dst       The output buffer, of width * height * channels bytes.
+ * \param norm      A pointer to the normalization parameters.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          0 if it succeeded or -1 if the format is not supported.
+ */
+int pi_cl_img_normalize_s8(struct pi_cl_img *src, int8_t *dst,
+  struct pi_cl_img_norm *norm, int nb_cores);
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif  /* __PMSIS_CLUSTER_DSP_CL_IMAGE_H__ */
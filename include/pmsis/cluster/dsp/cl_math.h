@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_CLUSTER_DSP_CL_MATH_H__
+#define __PMSIS_CLUSTER_DSP_CL_MATH_H__
+
+#include <stdint.h>
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterMath Math functions
+ *
+ * This set of functions provides the elementary functions used by neural
+ * network and signal processing kernels (exp, log, sigmoid, tanh, sqrt) in
+ * several precisions:
+ * - q7: signed 8 bits fixed-point.
+ * - q15: signed 16 bits fixed-point.
+ * - f16: half-precision float, on chips with a half-precision FPU and when
+ *   the compiler supports the _Float16 type.
+ * - f32: single-precision float.
+ *
+ * The functions are computed with a small lookup table giving the value on
+ * segments of the input range, refined with a polynomial of low degree whose
+ * coefficients depend on the precision, instead of the generic libm
+ * algorithms. The fixed-point formats of the inputs and outputs and the
+ * maximum errors are given for each function.
+ *
+ * The precision is selected at compile time by the name of the function, or
+ * with the generic macros such as pi_cl_math_sigmoid(q15, x) which paste the
+ * precision into the function name, so that a kernel can be written once for
+ * a precision given as a macro parameter. No dispatch is done at runtime.
+ *
+ * Every function is available in every precision, so that the generic macros
+ * can be used with any of them, except the f16 ones which are only declared
+ * when PI_CL_MATH_F16 is defined.
+ *
+ * The v2 and v4 variants process 2 q15 or 4 q7 values packed in 32 bits,
+ * using the packed-SIMD extensions when available. They exist for all the q15
+ * and q7 functions, with the same formats. The vect functions apply a
+ * function to a whole buffer on several cores.
+ */
+
+/**
+ * @addtogroup ClusterMath
+ * @{
+ */
+
+/**@{*/
+
+/** \brief 2 signed 16 bits values packed in 32 bits. */
+typedef int16_t pi_cl_v2s __attribute__((vector_size(4)));
+
+/** \brief 4 signed 8 bits values packed in 32 bits. */
+typedef int8_t pi_cl_v4s __attribute__((vector_size(4)));
+
+#if defined(__FLT16_MAX__)
+/** Defined when the half-precision functions are available. */
+#define PI_CL_MATH_F16 1
+/** \brief Half-precision float. */
+typedef _Float16 pi_cl_f16_t;
+#endif
+
+/** \enum pi_cl_math_func_e
+ * \brief Function identifier, used by the vect functions.
+ */
+typedef enum {
+  PI_CL_MATH_EXP     = 0, /*!< Exponential. */
+  PI_CL_MATH_LOG     = 1, /*!< Natural logarithm. */
+  PI_CL_MATH_SIGMOID = 2, /*!< Logistic sigmoid. */
+  PI_CL_MATH_TANH    = 3, /*!< Hyperbolic tangent. */
+  PI_CL_MATH_SQRT    = 4  /*!< Square root. */
+} pi_cl_math_func_e;
+
+/** \enum pi_cl_math_prec_e
+ * \brief Precision identifier, used by the vect functions.
+ */
+typedef enum {
+  PI_CL_MATH_PREC_Q7  = 0, /*!< q7, int8_t buffers. */
+  PI_CL_MATH_PREC_Q15 = 1, /*!< q15, int16_t buffers. */
+  PI_CL_MATH_PREC_F16 = 2, /*!< f16, pi_cl_f16_t buffers. */
+  PI_CL_MATH_PREC_F32 = 3  /*!< f32, float buffers. */
+} pi_cl_math_prec_e;
+
+/** \brief Generic exponential, e.g. pi_cl_math_exp(q15, x). */
+#define pi_cl_math_exp(prec, x) pi_cl_math_exp_ ## prec(x)
+/** \brief Generic natural logarithm, e.g. pi_cl_math_log(f32, x). */
+#define pi_cl_math_log(prec, x) pi_cl_math_log_ ## prec(x)
+/** \brief Generic sigmoid, e.g. pi_cl_math_sigmoid(q7, x). */
+#define pi_cl_math_sigmoid(prec, x) pi_cl_math_sigmoid_ ## prec(x)
+/** \brief Generic hyperbolic tangent, e.g. pi_cl_math_tanh(q15, x). */
+#define pi_cl_math_tanh(prec, x) pi_cl_math_tanh_ ## prec(x)
+/** \brief Generic square root, e.g. pi_cl_math_sqrt(q15, x). */
+#define pi_cl_math_sqrt(prec, x) pi_cl_math_sqrt_ ## prec(x)
+
+/** \brief Exponential, q7.
+ *
+ * \param x Input in Q4, must be negative or 0, i.e. from -8 to 0.
+ * \return  Output in Q7, saturated to 127. Maximum error is 1 LSB.
+ */
+int8_t pi_cl_math_exp_q7(int8_t x);
+
+/** \brief Natural logarithm, q7.
+ *
+ * \param x Input in Q4, must be positive, i.e. from 1/16 to 8.
+ * \return  Output in Q5, i.e. from -4 to 4. Maximum error is 1 LSB.
+ */
+int8_t pi_cl_math_log_q7(int8_t x);
+
+/** \brief Sigmoid, q7.
+ *
+ * \param x Input in Q4, i.e. from -8 to 8.
+ * \return  Output in Q7, saturated to 127. Maximum error is 1 LSB.
+ */
+int8_t pi_cl_math_sigmoid_q7(int8_t x);
+
+/** \brief Hyperbolic tangent, q7.
+ *
+ * \param x Input in Q5, i.e. from -4 to 4.
+ * \return  Output in Q7, saturated to 127. Maximum error is 1 LSB.
+ */
+int8_t pi_cl_math_tanh_q7(int8_t x);
+
+/** \brief Square root, q7.
+ *
+ * \param x Input in Q7, must be positive or 0.
+ * \return  Output in Q7. Maximum error is 1 LSB.
+ */
+int8_t pi_cl_math_sqrt_q7(int8_t x);
+
+/** \brief Exponential, q15.
+ *
+ * \param x Input in Q12, must be negative or 0, i.e. from -8 to 0.
+ * \return  Output in Q15, saturated to 32767. Maximum error is 2 LSB.
+ */
+int16_t pi_cl_math_exp_q15(int16_t x);
+
+/** \brief Natural logarithm, q15.
+ *
+ * The input is in Q8 rather than Q15, like the inputs of exp, sigmoid and
+ * tanh are in Q12, so that it covers a useful range, e.g. energies.
+ *
+ * \param x Input in Q8, must be positive, i.e. from 1/256 to 128.
+ * \return  Output in Q11, i.e. from -16 to 16. Maximum error is 1 LSB.
+ */
+int16_t pi_cl_math_log_q15(int16_t x);
+
+/** \brief Sigmoid, q15.
+ *
+ * \param x Input in Q12, i.e. from -8 to 8.
+ * \return  Output in Q15, saturated to 32767. Maximum error is 4 LSB.
+ */
+int16_t pi_cl_math_sigmoid_q15(int16_t x);
+
+/** \brief Hyperbolic tangent, q15.
+ *
+ * \param x Input in Q12, i.e. from -8 to 8.
+ * \return  Output in Q15, saturated to 32767. Maximum error is 4 LSB.
+ */
+int16_t pi_cl_math_tanh_q15(int16_t x);
+
+/** \brief Square root, q15.
+ *
+ * \param x Input in Q15, must be positive or 0.
+ * \return  Output in Q15. Maximum error is 1 LSB.
+ */
+int16_t pi_cl_math_sqrt_q15(int16_t x);
+
+/** \brief Exponential, f32. Maximum relative error is 2e-7. */
+float pi_cl_math_exp_f32(float x);
+/** \brief Natural logarithm, f32. Maximum absolute error is 2e-7. */
+float pi_cl_math_log_f32(float x);
+/** \brief Sigmoid, f32. Maximum absolute error is 2e-7. */
+float pi_cl_math_sigmoid_f32(float x);
+/** \brief Hyperbolic tangent, f32. Maximum absolute error is 2e-7. */
+float pi_cl_math_tanh_f32(float x);
+/** \brief Square root, f32. Correctly rounded. */
+float pi_cl_math_sqrt_f32(float x);
+
+#if defined(PI_CL_MATH_F16)
+/** \brief Exponential, f16. Maximum relative error is 1e-3. */
+pi_cl_f16_t pi_cl_math_exp_f16(pi_cl_f16_t x);
+/** \brief Natural logarithm, f16. Maximum absolute error is 1e-3. */
+pi_cl_f16_t pi_cl_math_log_f16(pi_cl_f16_t x);
+/** \brief Sigmoid, f16. Maximum absolute error is 1e-3. */
+pi_cl_f16_t pi_cl_math_sigmoid_f16(pi_cl_f16_t x);
+/** \brief Hyperbolic tangent, f16. Maximum absolute error is 1e-3. */
+pi_cl_f16_t pi_cl_math_tanh_f16(pi_cl_f16_t x);
+/** \brief Square root, f16. Correctly rounded. */
+pi_cl_f16_t pi_cl_math_sqrt_f16(pi_cl_f16_t x);
+#endif
+
+/** \brief Exponential on 4 packed q7 values, same formats as
+ * pi_cl_math_exp_q7. */
+pi_cl_v4s pi_cl_math_exp_q7_v4(pi_cl_v4s x);
+/** \brief Natural logarithm on 4 packed q7 values, same formats as
+ * pi_cl_math_log_q7. */
+pi_cl_v4s pi_cl_math_log_q7_v4(pi_cl_v4s x);
+/** \brief Sigmoid on 4 packed q7 values, same formats as
+ * pi_cl_math_sigmoid_q7. */
+pi_cl_v4s pi_cl_math_sigmoid_q7_v4(pi_cl_v4s x);
+/** \brief Hyperbolic tangent on 4 packed q7 values, same formats as
+ * pi_cl_math_tanh_q7. */
+pi_cl_v4s pi_cl_math_tanh_q7_v4(pi_cl_v4s x);
+/** \brief Square root on 4 packed q7 values, same formats as
+ * pi_cl_math_sqrt_q7. */
+pi_cl_v4s pi_cl_math_sqrt_q7_v4(pi_cl_v4s x);
+/** \brief Exponential on 2 packed q15 values, same formats as
+ * pi_cl_math_exp_q15. */
+pi_cl_v2s pi_cl_math_exp_q15_v2(pi_cl_v2s x);
+/** \brief Natural logarithm on 2 packed q15 values, same formats as
+ * pi_cl_math_log_q15. */
+pi_cl_v2s pi_cl_math_log_q15_v2(pi_cl_v2s x);
+/** \brief Sigmoid on 2 packed q15 values, same formats as
+ * pi_cl_math_sigmoid_q15. */
+pi_cl_v2s pi_cl_math_sigmoid_q15_v2(pi_cl_v2s x);
+/** \brief Hyperbolic tangent on 2 packed q15 values, same formats as
+ * pi_cl_math_tanh_q15. */
+pi_cl_v2s pi_cl_math_tanh_q15_v2(pi_cl_v2s x);
+/** \brief Square root on 2 packed q15 values, same formats as
+ * pi_cl_math_sqrt_q15. */
+pi_cl_v2s pi_cl_math_sqrt_q15_v2(pi_cl_v2s x);
+
+/** \brief Apply a function to a buffer.
+ *
+ * The buffer is split into one chunk per core and each core uses the v2 or v4
+ * variant for the fixed-point precisions. The chunks are multiples of the
+ * number of packed values, 2 for q15 and 4 for q7, except the last one. When
+ * size is not such a multiple, the remaining 1 to 3 values at the end of the
+ * buffer are processed one by one with the scalar function, which gives the
+ * same results. The input and output buffers can be the same.
+ * This must be called from the cluster controller core, outside of any team
+ * fork. The caller is blocked until the whole output is produced.
+ *
+ * \param func      The function to apply.
+ * \param prec      The precision, which gives the type of the buffers and the
+ *   formats of the values.
+ * \param in        Input buffer.
+ * \param out       Output buffer.
+ * \param size      Number of values. It does not need to be a multiple of
+ *   the number of packed values.
+ * \param nb_cores  Number of cores to use. If it is zero, the number of cores
+ *   of the previous fork is used.
+ * \return          0 if the operation is successfull, -1 if the precision is
+ *   f16 and PI_CL_MATH_F16 is not defined.
+ */
+int pi_cl_math_vect(pi_cl_math_func_e func, pi_cl_math_prec_e prec,
+  const void *in, void *out, int size, int nb_cores);
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif  /* __PMSIS_CLUSTER_DSP_CL_MATH_H__ */
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_CLUSTER_DSP_CL_MFCC_H__
+#define __PMSIS_CLUSTER_DSP_CL_MFCC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pmsis/cluster/dsp/cl_dsp.h"
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterMFCC MFCC front-end
+ *
+ * This set of functions provides an audio feature extractor running on the
+ * cluster, computing the Mel-frequency cepstral coefficients (MFCC) or the
+ * log-mel energies used by keyword spotting networks.
+ *
+ * The extractor consumes 16 bits PCM blocks of any size, typically the ones
+ * returned by pi_i2s_read or produced by the PDM decimator, and cuts them into
+ * overlapping frames of frame_size samples every hop_size samples. The samples
+ * which do not complete a frame are kept for the next block. For each frame:
+ * - a pre-emphasis filter and a window are applied.
+ * - the power spectrum is computed with a real FFT.
+ * - the power spectrum is integrated by the triangular mel filters, and the
+ *   logarithm of each mel energy is computed.
+ * - a DCT-II of the log-mel energies gives the cepstral coefficients.
+ *
+ * The FFT butterflies and the mel filters of each frame are distributed over
+ * the cores. All computations are in fixed-point, the FFT stages scaling their
+ * output to avoid overflows, so the extractor does not need an FPU. The log
+ * outputs are in Q(out_q), so a network trained on floating-point features
+ * must see them with the same scaling.
+ */
+
+/**
+ * @addtogroup ClusterMFCC
+ * @{
+ */
+
+/**@{*/
+
+/** \enum pi_cl_mfcc_window_e
+ * \brief Window applied to each frame.
+ */
+typedef enum {
+  PI_CL_MFCC_WINDOW_NONE    = 0, /*!< Rectangular window. */
+  PI_CL_MFCC_WINDOW_HANN    = 1, /*!< Hann window. */
+  PI_CL_MFCC_WINDOW_HAMMING = 2  /*!< Hamming window. */
+} pi_cl_mfcc_window_e;
+
+/** \struct pi_cl_mfcc_conf
+ * \brief MFCC extractor configuration structure.
+ */
+struct pi_cl_mfcc_conf
+{
+    uint32_t sample_rate;       /*!< Sampling rate of the input in Hz. */
+    uint16_t frame_size;        /*!< Number of samples per frame, at most
+      fft_size. Frames are zero-padded up to fft_size. */
+    uint16_t hop_size;          /*!< Number of samples between the beginning of
+      2 consecutive frames. */
+    uint16_t fft_size;          /*!< Number of points of the real FFT, a power
+      of 2 from 32 to 8192. */
+    uint16_t nb_mel;            /*!< Number of mel filters. */
+    uint16_t nb_dct;            /*!< Number of cepstral coefficients per frame.
+      If it is zero, the DCT is skipped and the nb_mel log-mel energies are
+      produced instead. */
+    uint16_t mel_fmin;          /*!< Lowest frequency of the mel filters in
+      Hz. */
+    uint16_t mel_fmax;          /*!< Highest frequency of the mel filters in Hz.
+      If it is zero, sample_rate / 2 is used. */
+    int16_t preemph;            /*!< Pre-emphasis coefficient in Q15, e.g.
+      0.97, or 0 to disable the pre-emphasis. */
+    pi_cl_mfcc_window_e window; /*!< Window applied to each frame. */
+    uint8_t out_q;              /*!< Number of fractional bits of the log
+      outputs. */
+    uint16_t max_block_size;    /*!< Maximum number of samples given to
+      pi_cl_mfcc_process at once, used to size the buffer of pending
+      samples. */
+    int nb_cores;               /*!< Number of cores used for each frame. If it
+      is zero, the number of cores of the previous fork is used. */
+};
+
+/** \brief MFCC extractor structure.
+ *
+ * This structure is used by the runtime to manage an extractor. It must be
+ * instantiated once for each audio stream and kept alive until the extractor
+ * is not used anymore.
+ */
+typedef struct pi_cl_mfcc_s pi_cl_mfcc_t;
+
+/** \brief Initialize an extractor configuration with default values.
+ *
+ * The default configuration extracts 13 MFCC from 40 mel filters, on frames of
+ * 25 ms every 10 ms of a 16 kHz stream with a 512 points FFT and a Hann
+ * window.
+ *
+ * \param conf A pointer to the extractor configuration.
+ */
+void pi_cl_mfcc_conf_init(struct pi_cl_mfcc_conf *conf);
+
+/** \brief Return the size of the extractor state.
+ *
+ * The extractor keeps the window, the FFT tables, the mel filters, the DCT
+ * matrix, the pending input samples and a work buffer in a state buffer
+ * allocated by the caller. The buffer should be allocated in cluster L1 memory
+ * to get the best performance.
+ *
+ * \param conf A pointer to the extractor configuration.
+ * \return     The size in bytes of the state buffer.
+ */
+size_t pi_cl_mfcc_state_size(struct pi_cl_mfcc_conf *conf);
+
+/** \brief Initialize an extractor.
+ *
+ * This computes the tables for the specified configuration and clears the
+ * pending samples. It can be called either from fabric-controller or cluster
+ * side.
+ *
+ * \param mfcc  A pointer to the extractor structure.
+ * \param conf  A pointer to the extractor configuration. It can be released
+ *   once this function returns.
+ * \param state The state buffer, whose size must be at least the one returned
+ *   by pi_cl_mfcc_state_size. It must be 4 bytes aligned and kept alive until
+ *   the extractor is not used anymore.
+ * \return      0 if the operation is successfull, -1 if the configuration is
+ *   not supported.
+ */
+int pi_cl_mfcc_init(pi_cl_mfcc_t *mfcc, struct pi_cl_mfcc_conf *conf,
+  void *state);
+
+/** \brief Reset an extractor.
+ *
+ * This drops the pending input samples and clears the pre-emphasis filter,
+ * e.g. after the audio interface has been stopped and restarted.
+ *
+ * \param mfcc  A pointer to the extractor structure.
+ */
+void pi_cl_mfcc_reset(pi_cl_mfcc_t *mfcc);
+
+/** \brief Return the number of values produced per frame.
+ *
+ * \param mfcc  A pointer to the extractor structure.
+ * \return      nb_dct, or nb_mel if the DCT is skipped.
+ */
+int pi_cl_mfcc_frame_size(pi_cl_mfcc_t *mfcc);
+
+/** \brief Extract the features of a block of samples.
+ *
+ * This appends the block to the pending samples and computes the features of
+ * all the complete frames, up to max_frames. The remaining samples are kept
+ * for the next call.
+ * This must be called from the cluster controller core, outside of any team
+ * fork, as the function forks on the configured number of cores. The caller
+ * is blocked until all the frames are processed.
+ *
+ * \param mfcc       A pointer to the extractor structure.
+ * \param in         The 16 bits PCM samples.
+ * \param nb_samples The number of samples in the block, at most
+ *   max_block_size.
+ * \param out        The buffer where the features are written, one frame after
+ *   the other, pi_cl_mfcc_frame_size values per frame.
+ * \param max_frames Maximum number of frames written to out. The samples of
+ *   the other frames are kept for the next call, so the next block must be
+ *   small enough for the pending samples to fit in
+ *   frame_size + max_block_size samples.
+ * \return           The number of frames written.
+ */
+int pi_cl_mfcc_process(pi_cl_mfcc_t *mfcc, const int16_t *in, int nb_samples,
+  int16_t *out, int max_frames);
+
+/** \brief Extract the features of a block of samples with the reference
+ * implementation.
+ *
+ * This runs the same fixed-point steps as pi_cl_mfcc_process on the calling
+ * core only, without any packed-SIMD instruction. It gives the cost of the
+ * extractor without the parallelization, e.g. to choose the number of
+ * cores.
+ *
+ * \param mfcc       A pointer to the extractor structure.
+ * \param in         The 16 bits PCM samples.
+ * \param nb_samples The number of samples in the block.
+ * \param out        The buffer where the features are written.
+ * \param max_frames Maximum number of frames written to out.
+ * \return           The number of frames written.
+ */
+int pi_cl_mfcc_process_ref(pi_cl_mfcc_t *mfcc, const int16_t *in,
+  int nb_samples, int16_t *out, int max_frames);
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+
+/// @cond IMPLEM
+
+struct pi_cl_mfcc_s
+{
+    struct pi_cl_mfcc_conf conf;
+    struct pi_cl_dsp_rfft rfft;
+    int16_t *window;
+    uint16_t *mel_bounds;
+    int16_t *mel_weights;
+    int16_t *dct;
+    int16_t *pending;
+    int16_t *work;
+    uint16_t nb_pending;
+    int16_t preemph_last;
+};
+
+/// @endcond
+
+#endif  /* __PMSIS_CLUSTER_DSP_CL_MFCC_H__ */
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_CLUSTER_DSP_CL_PDM_H__
+#define __PMSIS_CLUSTER_DSP_CL_PDM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @addtogroup clusterDriver
+ * @{
+ */
+
+/**
+ * @defgroup ClusterPDM PDM decimation
+ *
+ * This set of functions provides a software PDM to PCM converter running on
+ * the cluster.
+ *
+ * It is meant to be used when the I2S hardware PDM filter is not enough, for
+ * example when a custom filter response is needed or when more microphones
+ * than the hardware filter supports must be converted. In this case, the I2S
+ * interface is opened in PDM mode with pdm_filter_ena set to 0 so that the
+ * blocks returned by pi_i2s_read contain the raw PDM bitstream, and these
+ * blocks are then given to the decimator.
+ *
+ * The decimation is done in two stages. A CIC filter first decimates the
+ * 1-bit stream by a large factor, and a FIR filter then compensates the CIC
+ * droop and decimates by a small factor to produce 16 bits PCM samples:
+ *
+ *     PDM_freq = sampling_rate * cic_decimation * fir_decimation
+ *
+ * The channels are distributed over the cores of the team, so that each core
+ * filters one or several channels on its own. For a single channel, the FIR
+ * stage output samples are distributed over the cores instead.
+ * On chips with packed-SIMD extensions, the FIR stage processes 2 taps per
+ * instruction. The CIC stage, which works on the 1-bit stream, is usually the
+ * most expensive one, so the CIC decimation factor should be chosen as large
+ * as the FIR stage allows.
+ */
+
+/**
+ * @addtogroup ClusterPDM
+ * @{
+ */
+
+/**@{*/
+
+/** Maximum number of channels which can be decimated by one decimator. */
+#define PI_CL_PDM_MAX_CHANNELS      8
+
+/** Maximum order of the CIC stage. */
+#define PI_CL_PDM_MAX_CIC_ORDER     5
+
+/** \enum pi_cl_pdm_layout_e
+ * \brief Layout of the PDM bitstream.
+ *
+ * This describes how the bits of the different channels are organized in the
+ * raw PDM blocks.
+ */
+typedef enum {
+  PI_CL_PDM_LAYOUT_BIT_INTERLEAVED  = 0, /*!< Channels are interleaved bit
+    per bit, i.e. the first bit of each channel, then the second bit of each
+    channel and so on, LSB first. This is the layout produced by the I2S
+    interface when the PDM filter is disabled. */
+  PI_CL_PDM_LAYOUT_WORD_INTERLEAVED = 1  /*!< Channels are interleaved 32 bits
+    word per 32 bits word, LSB first. */
+} pi_cl_pdm_layout_e;
+
+/** \struct pi_cl_pdm_conf
+ * \brief PDM decimator configuration structure.
+ *
+ * This structure is used to pass the desired decimator configuration when
+ * initializing a decimator.
+ */
+struct pi_cl_pdm_conf
+{
+    uint8_t nb_channels;        /*!< Number of channels in the PDM stream. */
+    pi_cl_pdm_layout_e layout;  /*!< Layout of the channels in the PDM stream. */
+    uint8_t cic_order;          /*!< Order of the CIC stage, from 1 to
+      PI_CL_PDM_MAX_CIC_ORDER. */
+    uint16_t cic_decimation;    /*!< Decimation factor of the CIC stage. The
+      CIC integrators are 32 bits wide and their output grows by
+      cic_decimation ^ cic_order, so cic_order * ceil(log2(cic_decimation)) + 2
+      must not exceed 32, the 2 bits coming from the +1/-1 input samples. For
+      example, the order 5 is limited to a decimation of 64. */
+    int8_t cic_shift;           /*!< Right shift applied to the CIC output to
+      bring it to 16 bits. It is usually
+      cic_order * log2(cic_decimation) - 15. */
+    const int16_t *fir_coeffs;  /*!< FIR coefficients, in Q15. If NULL, a
+      default CIC compensation filter is used. */
+    uint16_t fir_nb_taps;       /*!< Number of FIR coefficients. Must be even
+      to allow packed-SIMD processing. */
+    uint8_t fir_decimation;     /*!< Decimation factor of the FIR stage. */
+    int8_t fir_shift;           /*!< Right shift applied to the FIR output. */
+    int nb_cores;               /*!< Number of cores used to decimate. If it is
+      zero, the number of cores of the previous fork is used. */
+};
+
+/** \brief PDM decimator structure.
+ *
+ * This structure is used by the runtime to manage a decimator. It must be
+ * instantiated once for each PDM stream and kept alive until the decimator is
+ * not used anymore.
+ */
+typedef struct pi_cl_pdm_s pi_cl_pdm_t;
+
+/** \brief Initialize a decimator configuration with default values.
+ *
+ * This function can be called to get default values for all parameters before
+ * setting some of them. The default configuration decimates one channel by
+ * 64 with a CIC of order 4 followed by a FIR decimating by 2.
+ *
+ * \param conf A pointer to the decimator configuration.
+ */
+void pi_cl_pdm_conf_init(struct pi_cl_pdm_conf *conf);
+
+/** \brief Return the size of the decimator state.
+ *
+ * The decimator keeps the CIC integrators, the FIR delay lines and a copy of
+ * the FIR coefficients in a state buffer allocated by the caller. This
+ * function returns the size in bytes of this buffer for the given
+ * configuration. The buffer should be allocated in cluster L1 memory to get
+ * the best performance.
+ *
+ * \param conf A pointer to the decimator configuration.
+ * \return     The size in bytes of the state buffer.
+ */
+size_t pi_cl_pdm_state_size(struct pi_cl_pdm_conf *conf);
+
+/** \brief Initialize a decimator.
+ *
+ * This initializes the decimator with the specified configuration and clears
+ * its state. It can be called either from fabric-controller or cluster side.
+ *
+ * \param pdm   A pointer to the decimator structure.
+ * \param conf  A pointer to the decimator configuration. It can be released
+ *   once this function returns.
+ * \param state The state buffer, whose size must be at least the one
+ *   returned by pi_cl_pdm_state_size. It must be 4 bytes aligned and kept
+ *   alive until the decimator is not used anymore.
+ * \return      0 if the operation is successfull, -1 if the configuration is
+ *   not supported, including when the CIC output does not fit in 32 bits (see
+ *   cic_decimation), as the integrators would then wrap silently.
+ */
+int pi_cl_pdm_init(pi_cl_pdm_t *pdm, struct pi_cl_pdm_conf *conf, void *state);
+
+/** \brief Reset a decimator.
+ *
+ * This clears the filter states, e.g. after the I2S interface has been stopped
+ * and restarted, so that old samples do not leak into the new stream.
+ *
+ * \param pdm   A pointer to the decimator structure.
+ */
+void pi_cl_pdm_reset(pi_cl_pdm_t *pdm);
+
+/** \brief Decimate a block of PDM samples.
+ *
+ * This converts a block of raw PDM samples into PCM samples. The block is
+ * typically the one returned by pi_i2s_read, and it may have been copied to
+ * cluster L1 memory before.
+ * This must be called from the cluster controller core, outside of any team
+ * fork, as the function forks on the configured number of cores. The caller
+ * is blocked until all the output samples are produced.
+ * Consecutive calls continue the same stream, the filter state being kept
+ * from one block to the next.
+ *
+ * \param pdm    A pointer to the decimator structure.
+ * \param in     The raw PDM block. It must be 4 bytes aligned.
+ * \param size   The size in bytes of the PDM block. It must be a multiple of
+ *   nb_channels * cic_decimation * fir_decimation / 8.
+ * \param out    The buffer where the 16 bits PCM samples are written,
+ *   interleaved per channel.
+ * \return       The number of PCM samples written per channel.
+ */
+int pi_cl_pdm_process(pi_cl_pdm_t *pdm, void *in, size_t size, int16_t *out);
+
+/** \brief Decimate a block of PDM samples from a team.
+ *
+ * This function is similar to pi_cl_pdm_process but must be called by all
+ * the cores of an already forked team, for example when the decimation is one
+ * step of a bigger multi-core pipeline. The cores are synchronized with a
+ * team barrier before returning.
+ *
+ * \param pdm    A pointer to the decimator structure.
+ * \param in     The raw PDM block. It must be 4 bytes aligned.
+ * \param size   The size in bytes of the PDM block.
+ * \param out    The buffer where the 16 bits PCM samples are written,
+ *   interleaved per channel.
+ * \return       The number of PCM samples written per channel.
+ */
+int pi_cl_pdm_process_team(pi_cl_pdm_t *pdm, void *in, size_t size,
+  int16_t *out);
+
+/** \brief Decimate a block of PDM samples with the reference implementation.
+ *
+ * This runs the same CIC and FIR filters as pi_cl_pdm_process on the calling
+ * core only, without any packed-SIMD instruction. It can be used to try a
+ * filter configuration before distributing it over the cores, and to measure
+ * what the parallel version gains.
+ *
+ * \param pdm    A pointer to the decimator structure.
+ * \param in     The raw PDM block. It must be 4 bytes aligned.
+ * \param size   The size in bytes of the PDM block.
+ * \param out    The buffer where the 16 bits PCM samples are written,
+ *   interleaved per channel.
+ * \return       The number of PCM samples written per channel.
+ */
+int pi_cl_pdm_process_ref(pi_cl_pdm_t *pdm, void *in, size_t size,
+  int16_t *out);
+
+//!@}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+
+/// @cond IMPLEM
+
+struct pi_cl_pdm_s
+{
+    struct pi_cl_pdm_conf conf;
+    int32_t *cic_state;
+    int16_t *fir_coeffs;
+    int16_t *fir_delay;
+    uint16_t fir_pos;
+    uint16_t fir_phase;
+};
+
+/// @endcond
+
+#endif  /* __PMSIS_CLUSTER_DSP_CL_PDM_H__ */
@@ -211,6 +211,202 @@ static inline void pi_cpi_set_filter(struct pi_device *device, uint32_t r_coeff,
 static inline void pi_cpi_set_slice(struct pi_device *device, uint32_t x,
   uint32_t y, uint32_t w, uint32_t h);
 
+/** \struct pi_cpi_ring_conf
+ * \brief CPI continuous capture configuration structure.
+ *
+ * This structure describes the ring of frame buffers used by the continuous
+ * capture mode.
+ */
+struct pi_cpi_ring_conf
+{
+    void **frames;          /*!< Array of nb_frames frame buffers. */
+    pi_task_t *tasks;       /*!< Array of nb_frames tasks. The task with the
+      same index as a frame buffer is pushed when this buffer has been filled
+      with a frame. */
+    uint32_t nb_frames;     /*!< Number of frame buffers in the ring. Must be
+      at least 2. */
+    uint32_t frame_size;    /*!< Size in bytes of one frame, which is also the
+      size of each buffer. */
+};
+
+/** \struct pi_cpi_frame
+ * \brief Captured frame descriptor.
+ *
+ * This structure is filled by pi_cpi_ring_frame_get to describe a frame
+ * captured in continuous mode.
+ */
+struct pi_cpi_frame
+{
+    void *buffer;           /*!< Buffer containing the frame. */
+    uint32_t size;          /*!< Number of bytes received in this buffer. */
+    uint32_t index;         /*!< Index of the buffer in the ring. */
+    uint32_t seq;           /*!< Sequence number of the frame, incremented
+      for every frame seen by the interface, including the dropped ones. The
+      difference between 2 consecutive seq minus 1 gives the number of frames
+      lost in between. */
+    uint32_t timestamp_us;  /*!< Time in micro-seconds, as returned by
+      pi_time_get_us, when the end of the frame was received. */
+};
+
+/** \struct pi_cpi_ring_stats
+ * \brief CPI continuous capture statistics.
+ */
+struct pi_cpi_ring_stats
+{
+    uint32_t frames_captured;   /*!< Number of frames written to the ring. */
+    uint32_t frames_dropped;    /*!< Number of frames dropped because all the
+      buffers of the ring were held by the application. */
+};
+
+/** \brief Start continuous capture.
+ *
+ * This starts capturing frames continuously in the ring of buffers given in
+ * the configuration. All the buffers are queued and the interface is started,
+ * so there is no need to call pi_cpi_control_start.
+ * Each time a buffer has been filled, its task is pushed and the buffer is
+ * held by the application until it is given back with
+ * pi_cpi_ring_frame_release, after which it is automatically queued again.
+ * This way the interface always has a buffer queued as long as the
+ * application releases frames in time, and no frame is lost when the
+ * frame rate is high, contrary to calling pi_cpi_capture_async for each frame.
+ * If all the buffers are held by the application when a new frame starts, the
+ * frame is dropped and counted in the statistics.
+ * The tasks must be initialized before calling this function and
+ * reinitialized before their frame is released.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param conf      A pointer to the ring configuration. The structure and the
+ *   arrays it points to must be kept alive until the capture is stopped.
+ * \return          0 if it succeeded or -1 if it failed.
+ */
+int pi_cpi_ring_start(struct pi_device *device, struct pi_cpi_ring_conf *conf);
+
+/** \brief Stop continuous capture.
+ *
+ * The interface is stopped and the buffers still queued are released. The
+ * caller is blocked until the current frame, if any, is finished, so that the
+ * buffers can be reused as soon as this function returns.
+ *
+ * \param device    A pointer to the structure describing the device.
+ */
+void pi_cpi_ring_stop(struct pi_device *device);
+
+/** \brief Get the oldest captured frame.
+ *
+ * This returns the description of the oldest frame filled and not yet
+ * returned by this function. It is typically called from the task of the
+ * frame. The frame buffer then belongs to the application until it is
+ * released.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param frame     A pointer to the structure where the frame description is
+ *   stored.
+ * \return          0 if a frame was available or -1 if there was none.
+ */
+int pi_cpi_ring_frame_get(struct pi_device *device,
+  struct pi_cpi_frame *frame);
+
+/** \brief Release a captured frame.
+ *
+ * This gives the frame buffer back to the driver, which queues it again so
+ * that it receives a following frame. Frames can be released in any order.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param frame     The frame description returned by pi_cpi_ring_frame_get.
+ */
+void pi_cpi_ring_frame_release(struct pi_device *device,
+  struct pi_cpi_frame *frame);
+
+/** \brief Get continuous capture statistics.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param stats     A pointer to the structure where the counters are stored.
+ */
+void pi_cpi_ring_stats_get(struct pi_device *device,
+  struct pi_cpi_ring_stats *stats);
+
+/** \struct pi_cpi_strip_conf
+ * \brief CPI strip capture configuration structure.
+ *
+ * This structure describes how frames are cut into strips of lines in strip
+ * capture mode.
+ */
+struct pi_cpi_strip_conf
+{
+    uint32_t line_size;     /*!< Size in bytes of one line, after slicing and
+      filtering, i.e. the width times the number of bytes per output pixel. */
+    uint16_t frame_lines;   /*!< Number of lines of one frame, after slicing. */
+    uint16_t strip_lines;   /*!< Number of lines of each strip. The last strip
+      of a frame may be shorter if frame_lines is not a multiple of it. */
+};
+
+/** \struct pi_cpi_strip
+ * \brief Captured strip descriptor.
+ *
+ * This structure is filled by pi_cpi_strip_status to describe a strip
+ * received in strip capture mode.
+ */
+struct pi_cpi_strip
+{
+    void *buffer;           /*!< Buffer containing the strip. */
+    uint16_t first_line;    /*!< Index in the frame of the first line of the
+      strip. */
+    uint16_t nb_lines;      /*!< Number of lines received in the buffer. */
+    uint8_t frame_start;    /*!< 1 if this is the first strip of a frame. */
+    uint8_t frame_end;      /*!< 1 if this is the last strip of a frame. */
+    uint32_t timestamp_us;  /*!< Time in micro-seconds, as returned by
+      pi_time_get_us, when the last line of the strip was received. */
+};
+
+/** \brief Configure strip capture mode.
+ *
+ * In strip mode, the buffers given to pi_cpi_strip_capture_async receive a
+ * fixed number of lines instead of a whole frame, and a notification is
+ * received for each strip. This allows processing the beginning of the frame,
+ * for example on the cluster, while the rest of the frame is still arriving,
+ * which reduces the latency and the amount of memory needed to hold images,
+ * as only a few strips have to be allocated instead of a full frame.
+ * This must be called while the interface is stopped.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param conf      A pointer to the strip configuration.
+ * \return          0 if it succeeded or -1 if the configuration is not
+ *   supported.
+ */
+int pi_cpi_strip_conf_set(struct pi_device *device,
+  struct pi_cpi_strip_conf *conf);
+
+/** \brief Capture a strip of lines asynchronously.
+ *
+ * Queue a buffer that will receive the next strip of lines from the CPI
+ * interface. The buffer must be at least line_size * strip_lines bytes.
+ * As with pi_cpi_capture_async, at least 2 buffers should always be queued
+ * so that no line is lost, by queueing a new one as soon as a strip has been
+ * received. Strips are filled in the order they are queued and never span 2
+ * frames, so the first strip following the last one of a frame always starts
+ * at line 0 of the next frame.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param buffer    The memory buffer where the strip will be transferred.
+ * \param task      The task used to notify the end of the strip. The strip
+ *   description can then be retrieved with pi_cpi_strip_status.
+ */
+void pi_cpi_strip_capture_async(struct pi_device *device, void *buffer,
+  pi_task_t *task);
+
+/** \brief Get the description of a received strip.
+ *
+ * After pi_cpi_strip_capture_async is called and the notification is
+ * received, this gives the position of the strip in the frame.
+ *
+ * \param task      The task used for notification.
+ * \param strip     A pointer to the structure where the strip description
+ *   is stored.
+ * \return          0 if it succeeded or -1 if the strip is incomplete
+ *   because the interface was stopped.
+ */
+int pi_cpi_strip_status(pi_task_t *task, struct pi_cpi_strip *strip);
+
 //!@}
 
 /**
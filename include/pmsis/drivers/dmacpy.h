@@ -29,10 +29,25 @@
  * This API provides support for UDMA memory copy(DMACPY).
  * The DMACPY allows memory copy between FC L1 memory and L2 memory.
  *
+ * Besides single copies, several copies can be enqueued with a single
+ * completion task, either as a 2D strided copy (e.g. to extract a window or
+ * pack lines of an image) or as a list of descriptors (scatter/gather).
+ *
+ * For small copies, the cost of programming the UDMA and waiting for its
+ * completion is higher than a copy done by the core. pi_dmacpy_memcpy can be
+ * used as a replacement for memcpy which chooses between both, using a size
+ * threshold given in the configuration or measured when the device is opened.
+ *
  * \addtogroup DMACPY
  * @{
  */
 
+/** Value of cpu_threshold asking for a measurement at open. */
+#define PI_DMACPY_CPU_THRESHOLD_MEASURE 0
+
+/** Default value of cpu_threshold, in bytes. */
+#define PI_DMACPY_CPU_THRESHOLD_DEFAULT 64
+
 /**
  * \struct pi_dmacpy_conf
  *
@@ -41,6 +56,14 @@
 struct pi_dmacpy_conf
 {
     uint8_t id;                 /*!< DMA memcpy device ID. */
+    uint32_t cpu_threshold;     /*!< Size in bytes under which pi_dmacpy_memcpy
+      uses a copy done by the core. pi_dmacpy_conf_init sets it to
+      PI_DMACPY_CPU_THRESHOLD_DEFAULT, which needs no measurement. If it is
+      PI_DMACPY_CPU_THRESHOLD_MEASURE, the threshold is measured when the
+      device is opened, by timing both copies on sizes from 16 bytes to 1
+      Kbyte. This gives the best threshold for the current frequencies, but
+      pi_dmacpy_open then lasts as long as these copies. 1 means that the core
+      is never used. */
 };
 
 /**
@@ -55,10 +78,25 @@ typedef enum
     PI_DMACPY_L2_L2 = 2            /*!< Memcpy from L2 to L2. */
 } pi_dmacpy_dir_e;
 
+/**
+ * \struct pi_dmacpy_desc
+ *
+ * \brief Copy descriptor, for copies made of several buffers.
+ */
+struct pi_dmacpy_desc
+{
+    void *src;                  /*!< Pointer to source buffer. */
+    void *dst;                  /*!< Pointer to dest buffer. */
+    uint32_t size;              /*!< Size of data to copy. */
+    pi_dmacpy_dir_e dir;        /*!< Direction of memcpy. */
+};
+
 /**
  * \brief Initialize DMA memcpy config.
  *
  * This function initializes DMA memcpy configuration struct with default values.
+ * The CPU threshold is set to PI_DMACPY_CPU_THRESHOLD_DEFAULT, so that
+ * pi_dmacpy_open does not measure it.
  *
  * \param conf           Pointer to DMA Memcpy conf struct.
  */
@@ -131,6 +169,133 @@ int pi_dmacpy_copy(struct pi_device *device, void *src, void *dst,
 int pi_dmacpy_copy_async(struct pi_device *device, void *src, void *dst,
                          uint32_t size, pi_dmacpy_dir_e dir, struct pi_task *task);
 
+/**
+ * \brief Synchronous 2D copy.
+ *
+ * A memory copy of several lines is done, the lines being separated by a
+ * stride in the source and in the destination buffers. A stride equal to the
+ * line length gives a contiguous buffer, so this can be used to pack or
+ * unpack lines.
+ *
+ * \param device         Pointer to device structure.
+ * \param src            Pointer to source buffer.
+ * \param dst            Pointer to dest buffer.
+ * \param size           Total size of data to copy, a multiple of length.
+ * \param src_stride     Number of bytes between the beginning of 2 lines in
+ *   the source buffer.
+ * \param dst_stride     Number of bytes between the beginning of 2 lines in
+ *   the dest buffer.
+ * \param length         Size of a line.
+ * \param dir            Direction of memcpy.
+ *
+ * \retval 0             If operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ *
+ * \note Both src and dst buffers, strides and length must be multiples of 4
+ * bytes.
+ */
+int pi_dmacpy_copy_2d(struct pi_device *device, void *src, void *dst,
+                      uint32_t size, uint32_t src_stride, uint32_t dst_stride,
+                      uint32_t length, pi_dmacpy_dir_e dir);
+
+/**
+ * \brief Asynchronous 2D copy.
+ *
+ * The lines are enqueued as successive UDMA transfers, and the task is
+ * notified once all of them are finished.
+ *
+ * \param device         Pointer to device structure.
+ * \param src            Pointer to source buffer.
+ * \param dst            Pointer to dest buffer.
+ * \param size           Total size of data to copy, a multiple of length.
+ * \param src_stride     Number of bytes between the beginning of 2 lines in
+ *   the source buffer.
+ * \param dst_stride     Number of bytes between the beginning of 2 lines in
+ *   the dest buffer.
+ * \param length         Size of a line.
+ * \param dir            Direction of memcpy.
+ * \param task           Event task used to notify end of copy.
+ *
+ * \retval 0             If operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ *
+ * \note Both src and dst buffers, strides and length must be multiples of 4
+ * bytes.
+ */
+int pi_dmacpy_copy_2d_async(struct pi_device *device, void *src, void *dst,
+                            uint32_t size, uint32_t src_stride,
+                            uint32_t dst_stride, uint32_t length,
+                            pi_dmacpy_dir_e dir, struct pi_task *task);
+
+/**
+ * \brief Synchronous copy of a descriptor list.
+ *
+ * The copies described by the descriptors are done one after the other.
+ *
+ * \param device         Pointer to device structure.
+ * \param descs          Array of copy descriptors.
+ * \param nb_descs       Number of descriptors.
+ *
+ * \retval 0             If operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ *
+ * \note The same alignment constraints as pi_dmacpy_copy apply to each
+ * descriptor.
+ */
+int pi_dmacpy_copy_list(struct pi_device *device,
+                        const struct pi_dmacpy_desc *descs, int nb_descs);
+
+/**
+ * \brief Asynchronous copy of a descriptor list.
+ *
+ * The next copy is enqueued from the end of transfer interrupt of the
+ * previous one, and the task is notified once all of them are finished.
+ *
+ * \param device         Pointer to device structure.
+ * \param descs          Array of copy descriptors. It must be kept alive
+ *   until the task is notified.
+ * \param nb_descs       Number of descriptors.
+ * \param task           Event task used to notify end of copy.
+ *
+ * \retval 0             If operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ *
+ * \note The same alignment constraints as pi_dmacpy_copy apply to each
+ * descriptor.
+ */
+int pi_dmacpy_copy_list_async(struct pi_device *device,
+                              const struct pi_dmacpy_desc *descs, int nb_descs,
+                              struct pi_task *task);
+
+/**
+ * \brief Copy with the fastest method.
+ *
+ * This can be used as a replacement for memcpy. The copy is done by the core
+ * if the size is smaller than the threshold of the device, if the buffers or
+ * the size are not multiples of 4 bytes, or if the direction is not supported
+ * by the UDMA. Otherwise, it is done with a synchronous DMA copy, the
+ * direction being deduced from the buffer addresses.
+ *
+ * \param device         Pointer to device structure.
+ * \param dst            Pointer to dest buffer.
+ * \param src            Pointer to source buffer.
+ * \param size           Size of data to copy.
+ *
+ * \return               The dest buffer.
+ */
+void *pi_dmacpy_memcpy(struct pi_device *device, void *dst, const void *src,
+                       uint32_t size);
+
+/**
+ * \brief Get the threshold used by pi_dmacpy_memcpy.
+ *
+ * \param device         Pointer to device structure.
+ *
+ * \return               The size in bytes under which the copy is done by
+ *   the core, either given in the configuration or measured at open.
+ */
+uint32_t pi_dmacpy_cpu_threshold_get(struct pi_device *device);
+
 /**
  * @}
  */
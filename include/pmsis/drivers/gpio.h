@@ -199,6 +199,279 @@ void pi_gpio_pin_notif_clear(struct pi_device *device, uint32_t pin);
  */
 int pi_gpio_pin_notif_get(struct pi_device *device, uint32_t pin);
 
+/** \brief Configure several GPIOs.
+ *
+ * This function can be used to configure with the same flags all the GPIOs
+ * of a port which are set in a mask.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param mask           A mask of the GPIOs to configure, bit i for GPIO i.
+ * \param flags          A bitfield of flags specifying how to configure the
+ *   GPIOs.
+ *
+ * \retval               0 if the operation is successfull,
+ * \retval               ERROR_CODE if there was an error.
+ */
+int pi_gpio_mask_configure(struct pi_device *device, uint32_t mask,
+                           pi_gpio_flags_e flags);
+
+/** \brief Set the value of several GPIOs.
+ *
+ * The GPIOs set in the mask get the value of the corresponding bit of value,
+ * in a single write to the port output register, so that they all change at
+ * the same time. The other GPIOs are not modified.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param mask           A mask of the GPIOs to write, bit i for GPIO i.
+ * \param value          The values of the GPIOs, bit i for GPIO i.
+ *
+ * \retval               0 if the operation is successfull,
+ * \retval               ERROR_CODE if there was an error.
+ */
+int pi_gpio_mask_write(struct pi_device *device, uint32_t mask, uint32_t value);
+
+/** \brief Get the value of several GPIOs.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param mask           A mask of the GPIOs to read, bit i for GPIO i.
+ * \param value          A pointer to the variable where the values are
+ *   returned, bit i for GPIO i. The bits which are not in the mask are 0.
+ *
+ * \retval               0 if the operation is successfull,
+ * \retval               ERROR_CODE if there was an error.
+ */
+int pi_gpio_mask_read(struct pi_device *device, uint32_t mask, uint32_t *value);
+
+/** \brief Set several GPIOs to 1.
+ *
+ * The port output register is updated atomically, i.e. this can be called
+ * from an interrupt handler while another part of the code is modifying
+ * other GPIOs of the same port.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param mask           A mask of the GPIOs to set, bit i for GPIO i.
+ */
+void pi_gpio_mask_set(struct pi_device *device, uint32_t mask);
+
+/** \brief Set several GPIOs to 0.
+ *
+ * The port output register is updated atomically.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param mask           A mask of the GPIOs to clear, bit i for GPIO i.
+ */
+void pi_gpio_mask_clear(struct pi_device *device, uint32_t mask);
+
+/** \brief Invert several GPIOs.
+ *
+ * The port output register is updated atomically.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param mask           A mask of the GPIOs to invert, bit i for GPIO i.
+ */
+void pi_gpio_mask_toggle(struct pi_device *device, uint32_t mask);
+
+/** \struct pi_gpio_pattern_conf
+ * \brief GPIO pattern configuration structure.
+ *
+ * This structure describes a precomputed sequence of values written to a set
+ * of GPIOs, e.g. to bit-bang a parallel bus.
+ */
+struct pi_gpio_pattern_conf
+{
+    uint32_t mask;          /*!< Mask of the GPIOs driven by the pattern, which
+      must be configured as outputs. The other GPIOs are not modified. */
+    const uint32_t *values; /*!< Values of the port, one per step. Only the
+      bits of the mask are used. */
+    uint32_t nb_values;     /*!< Number of steps. */
+    uint32_t step_cycles;   /*!< Duration of each step in fabric controller
+      cycles, or 0 to write the values as fast as possible. */
+    uint32_t repeat;        /*!< Number of times the whole pattern is played,
+      at least 1. */
+};
+
+/** \brief Initialize a GPIO pattern configuration with default values.
+ *
+ * The default configuration plays the pattern once, as fast as possible. The
+ * mask and the values must still be set.
+ *
+ * \param conf           A pointer to the pattern configuration.
+ */
+void pi_gpio_pattern_conf_init(struct pi_gpio_pattern_conf *conf);
+
+/** \brief Play a GPIO pattern.
+ *
+ * The values are written one after the other with single writes to the port
+ * output register. Steps shorter than the interrupt latency are played by the
+ * fabric controller in a loop with interrupts disabled, so that the timing
+ * stays exact, while longer steps are played from timer interrupts.
+ * The caller is blocked until the whole pattern is played.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param conf           A pointer to the pattern configuration.
+ *
+ * \retval               0 if the operation is successfull,
+ * \retval               ERROR_CODE if there was an error.
+ */
+int pi_gpio_pattern_play(struct pi_device *device,
+                         struct pi_gpio_pattern_conf *conf);
+
+/** \brief Play a GPIO pattern asynchronously.
+ *
+ * This is the same as pi_gpio_pattern_play, except that the call returns
+ * before the end of the pattern. The task is triggered at the end. The
+ * configuration and the values must be kept alive until then.
+ * Short steps are still played with interrupts disabled, so the call only
+ * returns early when the steps are played from timer interrupts.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param conf           A pointer to the pattern configuration.
+ * \param task           The task used to notify the end of the pattern.
+ *
+ * \retval               0 if the operation is successfull,
+ * \retval               ERROR_CODE if there was an error.
+ */
+int pi_gpio_pattern_play_async(struct pi_device *device,
+                               struct pi_gpio_pattern_conf *conf,
+                               pi_task_t *task);
+
+/** \brief GPIO capture event.
+ *
+ * This structure describes one edge recorded by the capture mode.
+ */
+typedef struct
+{
+    uint32_t timestamp; /*!< Time of the edge in fabric controller cycles,
+      wrapping around on 32 bits, i.e. every 2^32 / FC frequency seconds,
+      about 17 seconds at 250 MHz. Cycles are used instead of the
+      microseconds of pi_time_get_us to resolve short pulses. Durations can
+      be converted with pi_gpio_capture_duration_us. */
+    uint32_t mask;      /*!< Mask of the captured GPIOs which got an edge. */
+    uint32_t value;     /*!< Value of the port after the edge. */
+} pi_gpio_capture_event_t;
+
+/** \struct pi_gpio_capture_conf
+ * \brief GPIO capture configuration structure.
+ *
+ * This structure is used to pass the desired capture configuration to the
+ * runtime when starting a capture.
+ */
+struct pi_gpio_capture_conf
+{
+    uint32_t mask;                   /*!< Mask of the GPIOs to capture, which must
+      be configured as inputs. */
+    pi_gpio_notif_e edge;            /*!< Edges recorded on each GPIO. */
+    pi_gpio_capture_event_t *buffer; /*!< Ring buffer where the events are
+      recorded. It must be kept alive until the capture is stopped. */
+    uint32_t nb_events;              /*!< Number of events of the ring buffer,
+      which must be a power of 2. */
+    uint32_t batch;                  /*!< Number of events which must be
+      available before the notification task is triggered. */
+    uint32_t timeout_us;             /*!< If not zero, the notification task is
+      also triggered when at least one event is available and no new edge
+      happened during this time, so that the end of a pulse train is seen. */
+};
+
+/** \struct pi_gpio_capture_stats
+ * \brief GPIO capture statistics.
+ */
+struct pi_gpio_capture_stats
+{
+    uint32_t events;    /*!< Number of events recorded since the capture was
+      started. */
+    uint32_t overflows; /*!< Number of events lost because the ring buffer was
+      full. */
+};
+
+/** \brief Initialize a GPIO capture configuration with default values.
+ *
+ * The default configuration captures both edges, with a notification after
+ * each event and no timeout. The mask and the buffer must still be set.
+ *
+ * \param conf           A pointer to the capture configuration.
+ */
+void pi_gpio_capture_conf_init(struct pi_gpio_capture_conf *conf);
+
+/** \brief Start capturing GPIO edges.
+ *
+ * Once started, each edge on the captured GPIOs is timestamped and recorded
+ * into the ring buffer by the interrupt handler, without any task being
+ * pushed, so that pulse trains of several kHz can be captured with a low
+ * overhead. The events are then read in batches with pi_gpio_capture_read.
+ * Edges happening on several GPIOs before the interrupt is handled are merged
+ * into a single event. When the ring buffer is full, new events are dropped
+ * and counted as overflows.
+ * Only one capture can be active per port, and the captured GPIOs cannot
+ * also be used with pi_gpio_pin_task_add.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param conf           A pointer to the capture configuration. It can be
+ *   released once this function returns.
+ *
+ * \retval               0 if the operation is successfull,
+ * \retval               ERROR_CODE if there was an error.
+ */
+int pi_gpio_capture_start(struct pi_device *device,
+                          struct pi_gpio_capture_conf *conf);
+
+/** \brief Stop capturing GPIO edges.
+ *
+ * The events already recorded can still be read, and a pending notification
+ * task is triggered if events are available.
+ *
+ * \param device         A pointer to the device structure of the port.
+ */
+void pi_gpio_capture_stop(struct pi_device *device);
+
+/** \brief Wait for a batch of capture events.
+ *
+ * The task is triggered once at least batch events are available, or when
+ * the timeout of the configuration expires. It is triggered only once, so
+ * this function must be called again, typically from the task callback after
+ * the events have been read, to get the next batch.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param task           The task used to notify the batch.
+ */
+void pi_gpio_capture_notify(struct pi_device *device, pi_task_t *task);
+
+/** \brief Read capture events.
+ *
+ * This copies the oldest events from the ring buffer and removes them from it.
+ * It can be called at any time, from a task callback or from a thread.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param events         The array where the events are copied.
+ * \param max_events     The maximum number of events to copy.
+ *
+ * \return               The number of events copied.
+ */
+uint32_t pi_gpio_capture_read(struct pi_device *device,
+                              pi_gpio_capture_event_t *events,
+                              uint32_t max_events);
+
+/** \brief Convert the time between two capture events to microseconds.
+ *
+ * The difference is computed modulo 2^32, so it is correct across one wrap of
+ * the timestamps, i.e. for events less than 2^32 FC cycles apart. It uses the
+ * current FC frequency, which must not have changed between the two events.
+ *
+ * \param start          Timestamp of the first event.
+ * \param end            Timestamp of the second event.
+ *
+ * \return               The time between the events in microseconds.
+ */
+uint32_t pi_gpio_capture_duration_us(uint32_t start, uint32_t end);
+
+/** \brief Get the statistics of the capture.
+ *
+ * \param device         A pointer to the device structure of the port.
+ * \param stats          A pointer to the structure where the statistics are
+ *   stored.
+ */
+void pi_gpio_capture_stats_get(struct pi_device *device,
+                               struct pi_gpio_capture_stats *stats);
+
 //!@}
 
 /**
@@ -209,13 +482,6 @@ int pi_gpio_pin_notif_get(struct pi_device *device, uint32_t pin);
 
 /// @cond IMPLEM
 
-int pi_gpio_mask_configure(struct pi_device *device, uint32_t mask,
-                           pi_gpio_flags_e flags);
-
-int pi_gpio_mask_write(struct pi_device *device, uint32_t mask, uint32_t value);
-
-int pi_gpio_mask_read(struct pi_device *device, uint32_t mask, uint32_t *value);
-
 int pi_gpio_mask_task_add(struct pi_device *device, uint32_t mask,
                           pi_task_t *task, pi_gpio_notif_e flags);
 
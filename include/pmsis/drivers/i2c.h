@@ -42,6 +42,7 @@
 /// @cond IMPLEM
 
 #define __PI_I2C_CTRL_SET_MAX_BAUDRATE_BIT 0
+#define __PI_I2C_CTRL_SET_RETRY_BIT 1
 
 /// @endcond
 
@@ -92,8 +93,74 @@ typedef enum {
 typedef enum {
   PI_I2C_CTRL_SET_MAX_BAUDRATE  = 1 << __PI_I2C_CTRL_SET_MAX_BAUDRATE_BIT, /*!< 
     Change maximum baudrate. */
+  PI_I2C_CTRL_SET_RETRY         = 1 << __PI_I2C_CTRL_SET_RETRY_BIT, /*!<
+    Change the retry policy of pi_i2c_transfer. The argument must be a pointer
+    to a struct pi_i2c_retry. */
 } pi_i2c_ioctl_e;
 
+/** \enum pi_i2c_status_e
+ * \brief Status of I2C transfers.
+ *
+ * This is returned by pi_i2c_transfer and pi_i2c_get_request_status to tell
+ * how a transfer ended.
+ */
+typedef enum {
+  PI_I2C_OK            = 0,  /*!< The transfer was successfull. */
+  PI_I2C_ERR_NACK      = -1, /*!< The device did not acknowledge its address
+    or a written byte. */
+  PI_I2C_ERR_ARB_LOST  = -2, /*!< Arbitration was lost to another master. */
+  PI_I2C_ERR_TIMEOUT   = -3, /*!< The bus was held busy for too long, e.g. by
+    a device stretching the clock. */
+  PI_I2C_ERR_INVALID   = -4  /*!< The messages are invalid, e.g. empty. */
+} pi_i2c_status_e;
+
+/** \enum pi_i2c_msg_flags_e
+ * \brief Properties of I2C messages.
+ *
+ * This is used to specify the direction of each message given to
+ * pi_i2c_transfer.
+ */
+typedef enum {
+  PI_I2C_MSG_WRITE     = 0<<0,  /*!< Write the message buffer to the device. */
+  PI_I2C_MSG_READ      = 1<<0,  /*!< Read the message buffer from the
+    device. */
+  PI_I2C_MSG_STOP      = 1<<1   /*!< Generate a STOP bit at the end of the
+    message. It is always generated after the last message. */
+} pi_i2c_msg_flags_e;
+
+/** \struct pi_i2c_msg
+ * \brief I2C message.
+ *
+ * This describes one part of a combined transfer. Consecutive messages are
+ * separated by a repeated START bit unless PI_I2C_MSG_STOP is given, in which
+ * case a STOP and a new START are generated.
+ */
+typedef struct pi_i2c_msg
+{
+    uint8_t *buf;               /*!< Address in the chip of the data to
+      write or of the buffer receiving the data read. */
+    uint16_t len;               /*!< Size in bytes of the message. */
+    uint16_t addr;              /*!< Slave address (7 bits on MSB) of the
+      device. If it is 0, the address of the opened device is used. */
+    pi_i2c_msg_flags_e flags;   /*!< Message direction and stop bit. */
+} pi_i2c_msg_t;
+
+/** \struct pi_i2c_retry
+ * \brief I2C retry policy.
+ *
+ * This describes how many times pi_i2c_transfer retries the whole sequence of
+ * messages when it fails. The default policy does no retry.
+ */
+struct pi_i2c_retry
+{
+    uint8_t nb_retries;         /*!< Maximum number of retries. */
+    uint8_t on_nack;            /*!< 1 to retry when the device does not
+      acknowledge, e.g. for devices which are busy after a write. */
+    uint8_t on_arb_lost;        /*!< 1 to retry when arbitration is lost. */
+    uint32_t delay_us;          /*!< Delay in micro-seconds before each retry.
+      The delay is applied without blocking the fabric controller. */
+};
+
 /** \brief Initialize an I2C configuration with default values.
  *
  * This function can be called to get default values for all parameters before
@@ -224,6 +291,75 @@ void pi_i2c_read_async(struct pi_device *device, uint8_t *rx_buff, int length,
 void pi_i2c_write_async(struct pi_device *device, uint8_t *tx_data, int length,
   pi_i2c_xfer_flags_e flags, pi_task_t *task);
 
+/** \brief Execute a sequence of I2C messages.
+ *
+ * This function executes all the specified messages in a single driver pass,
+ * without any notification between them, which for example allows reading a
+ * register with a write of the register address followed by a read with a
+ * repeated START, with only one wakeup of the caller.
+ * The sequence stops at the first error. If a retry policy was set with
+ * PI_I2C_CTRL_SET_RETRY, the whole sequence is then retried.
+ * The caller is blocked until the transfer is finished.
+ * Depending on the chip, there may be some restrictions on the memory which
+ * can be used. Check the chip-specific documentation for more details.
+ *
+ * \param device  A pointer to the structure describing the device.
+ * \param msgs    Array of messages. It must be kept alive until the transfer
+ *   is finished.
+ * \param nb_msgs Number of messages.
+ * \return        PI_I2C_OK if the transfer was successfull, otherwise a
+ *   negative value of pi_i2c_status_e describing the last error.
+ */
+int pi_i2c_transfer(struct pi_device *device, pi_i2c_msg_t *msgs, int nb_msgs);
+
+/** \brief Execute a sequence of I2C messages asynchronously.
+ *
+ * This function is similar to pi_i2c_transfer but does not block the caller.
+ * A task must be specified in order to specify how the caller should be
+ * notified when the transfer is finished. The status of the transfer can
+ * then be retrieved with pi_i2c_get_request_status.
+ *
+ * \param device  A pointer to the structure describing the device.
+ * \param msgs    Array of messages. It must be kept alive until the transfer
+ *   is finished.
+ * \param nb_msgs Number of messages.
+ * \param task    The task used to notify the end of transfer.
+ *   See the documentation of pi_task_t for more details.
+ */
+void pi_i2c_transfer_async(struct pi_device *device, pi_i2c_msg_t *msgs,
+  int nb_msgs, pi_task_t *task);
+
+/** \brief Get the status of an asynchronous transfer.
+ *
+ * After pi_i2c_transfer_async, pi_i2c_read_async or pi_i2c_write_async is
+ * called and the notification is received, this gives how the transfer
+ * ended.
+ *
+ * \param task    The task used for notification.
+ * \return        PI_I2C_OK if the transfer was successfull, otherwise a
+ *   negative value of pi_i2c_status_e.
+ */
+int pi_i2c_get_request_status(pi_task_t *task);
+
+/** \brief Read registers of an I2C device.
+ *
+ * This is a helper doing the common register read sequence with
+ * pi_i2c_transfer: the register address is written, followed by a read with a
+ * repeated START.
+ *
+ * \param device    A pointer to the structure describing the device.
+ * \param reg       The address of the buffer containing the register
+ *   address.
+ * \param reg_len   The size in bytes of the register address.
+ * \param rx_buff   The address in the chip where the received data must be
+ *   written.
+ * \param length    The size in bytes to read.
+ * \return          PI_I2C_OK if the transfer was successfull, otherwise a
+ *   negative value of pi_i2c_status_e.
+ */
+int pi_i2c_write_read(struct pi_device *device, uint8_t *reg, int reg_len,
+  uint8_t *rx_buff, int length);
+
 //!@}
 
 /**
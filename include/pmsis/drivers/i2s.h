@@ -213,6 +213,65 @@ enum pi_i2s_ioctl_cmd
      * stored.
      */
     PI_I2S_IOCTL_CH_CONF_GET,
+
+    /** @brief Get the RX statistics of the interface.
+     *
+     * This command can be used at any time to get the counters describing
+     * how well the application keeps up with the incoming samples. The
+     * argument must be a pointer to a structure of type struct pi_i2s_stats
+     * where the counters will be stored.
+     */
+    PI_I2S_IOCTL_STATS_GET,
+
+    /** @brief Reset the RX statistics of the interface.
+     *
+     * All counters of struct pi_i2s_stats are set to 0. This can be used
+     * for example to ignore the start-up phase of the application when
+     * measuring the latency. The argument is ignored.
+     */
+    PI_I2S_IOCTL_STATS_RESET,
+
+    /** @brief Set the overrun notification.
+     *
+     * The argument must be a pointer to a pi_task_t which will be pushed the
+     * next time a block is dropped because the application did not read the
+     * previous ones in time. The task is pushed only once and must be set
+     * again with this command to be notified of the following overruns.
+     * NULL can be given to remove a pending notification.
+     */
+    PI_I2S_IOCTL_OVERRUN_NOTIF_SET,
+};
+
+/**
+ * \struct pi_i2s_stats
+ *
+ * \brief RX statistics.
+ *
+ * This structure gives the counters maintained by the driver to detect lost
+ * blocks and measure how late the application is when consuming them. They
+ * can be used to tune the block_size and the number of blocks of the
+ * configuration to get the lowest latency without losing samples.
+ *
+ * In ping pong mode, a block is dropped when both buffers have been filled and
+ * the application has not read the oldest one yet. The interface then
+ * overwrites it. In mem slab mode, a block is dropped when no free block can
+ * be allocated from the slab to receive the next samples, in which case
+ * slab_exhausted is also incremented.
+ */
+struct pi_i2s_stats
+{
+    uint32_t blocks_delivered;  /*!< Number of blocks returned to the
+      application through pi_i2s_read or pi_i2s_read_async. */
+    uint32_t blocks_dropped;    /*!< Number of blocks whose samples were lost
+      because the application did not consume them in time. */
+    uint32_t slab_exhausted;    /*!< Number of times no free block could be
+      allocated from the memory slab. */
+    uint32_t max_latency_us;    /*!< Maximum time in micro-seconds between the
+      end of reception of a block and its delivery to the application. */
+    uint32_t last_latency_us;   /*!< Same as max_latency_us but for the last
+      block delivered. */
+    uint8_t max_pending;        /*!< Maximum number of filled blocks which
+      were waiting to be read by the application at the same time. */
 };
 
 /**
@@ -241,7 +300,10 @@ struct pi_i2s_conf
                                   - sampling_rate is the audio sampling rate(22050kHz, 44100kHZ, 48000kHZ,...).
                                   - pdm_decimation is the decimation factor to apply. */
     int8_t pdm_shift;           /*!< In PDM mode, the shift value to shift data when applying filter. */
-    uint8_t pdm_filter_ena;     /*!< When using PDM mode, enable PDM filter. */
+    uint8_t pdm_filter_ena;     /*!< When using PDM mode, enable PDM filter.
+                                  If it is disabled, the blocks contain the raw
+                                  PDM bitstream, which can then be decimated
+                                  in software, see pi_cl_pdm_process. */
 };
 
 /**
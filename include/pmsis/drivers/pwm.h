@@ -317,6 +317,114 @@ static inline void pi_pwm_timer_stop(struct pi_device *device);
 int32_t pi_pwm_duty_cycle_set(struct pi_device *device,
                               uint32_t frequency, uint8_t duty_cycle);
 
+/**
+ * \struct pi_pwm_seq_conf
+ * \brief PWM sequencer configuration structure.
+ *
+ * The sequencer updates the thresholds of several channels of a PWM device at
+ * the end of each timer period, from buffers of precomputed values, e.g. to
+ * generate audio or motor commutation waveforms.
+ */
+struct pi_pwm_seq_conf
+{
+    uint8_t channel_mask;      /*!< Mask of the channels updated by the
+      sequencer, bit i for channel i. The channels must already be configured
+      with PI_PWM_CH_CONFIG. */
+    uint16_t periods_per_step; /*!< Number of timer periods each step is held,
+      at least 1. */
+    uint8_t stop_on_underrun;  /*!< 1 to stop the timer on underrun, 0 to keep
+      the thresholds of the last step. */
+};
+
+/**
+ * \struct pi_pwm_seq_stats
+ * \brief PWM sequencer statistics.
+ */
+struct pi_pwm_seq_stats
+{
+    uint32_t steps;     /*!< Number of steps played. */
+    uint32_t underruns; /*!< Number of steps for which no buffer was queued. */
+};
+
+/**
+ * \brief Initialize a PWM sequencer configuration structure.
+ *
+ * This function initializes a PWM sequencer configuration structure with
+ * default values: channel 0 only, one period per step, no stop on underrun.
+ *
+ * \param conf           PWM sequencer configuration structure.
+ */
+void pi_pwm_seq_conf_init(struct pi_pwm_seq_conf *conf);
+
+/**
+ * \brief Start a PWM sequencer.
+ *
+ * This function enables the sequencer on an opened PWM device and starts the
+ * timer. The steps are played from the buffers queued with
+ * pi_pwm_seq_enqueue. Buffers should be queued before starting to avoid an
+ * underrun on the first period.
+ * At each step, the thresholds of all the channels of the mask are written
+ * and then applied together with an update command, so that they take
+ * effect at the same period end.
+ * The PWM timers have no UDMA channel, so the thresholds are written by the
+ * fabric controller from the timer interrupt, which still happens once per
+ * step. Only the task notifications are reduced, to one per buffer.
+ *
+ * \param device         Device structure.
+ * \param conf           PWM sequencer configuration structure. It can be
+ *   released once this function returns.
+ *
+ * \retval 0             If operation is successful.
+ * \retval ERR_CODE      Otherwise.
+ */
+int32_t pi_pwm_seq_start(struct pi_device *device,
+                         struct pi_pwm_seq_conf *conf);
+
+/**
+ * \brief Queue a buffer of thresholds.
+ *
+ * The buffer contains one threshold per channel of the mask for each step,
+ * in channel order, i.e. nb_steps * nb_channels values. Buffers are played in
+ * the order they are queued. The task is triggered once the last step of the
+ * buffer has been loaded, so that the buffer can be refilled and queued again.
+ * Queueing at least 2 buffers lets the caller refill one while the other is
+ * played, with one notification per buffer instead of one per step. The
+ * timer interrupt is still handled at each step, see pi_pwm_seq_start.
+ * This can be called before or after the sequencer is started.
+ *
+ * \param device         Device structure.
+ * \param thresholds     Buffer of thresholds. It must be kept alive until the
+ *   task is triggered.
+ * \param nb_steps       Number of steps of the buffer.
+ * \param task           Task triggered at the end of the buffer, or NULL.
+ *
+ * \retval 0             If operation is successful.
+ * \retval ERR_CODE      Otherwise.
+ */
+int32_t pi_pwm_seq_enqueue(struct pi_device *device,
+                           const uint16_t *thresholds, uint32_t nb_steps,
+                           pi_task_t *task);
+
+/**
+ * \brief Stop a PWM sequencer.
+ *
+ * This function stops the timer and disables the sequencer. The tasks of the
+ * buffers which were not fully played are triggered.
+ *
+ * \param device         Device structure.
+ */
+void pi_pwm_seq_stop(struct pi_device *device);
+
+/**
+ * \brief Get the statistics of a PWM sequencer.
+ *
+ * \param device         Device structure.
+ * \param stats          Structure where the statistics are stored.
+ * \param reset          1 to reset the statistics after they are read.
+ */
+void pi_pwm_seq_stats_get(struct pi_device *device,
+                          struct pi_pwm_seq_stats *stats, int reset);
+
 /**
  * @} end of PWM
  */
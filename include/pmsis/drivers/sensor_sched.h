@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PI_DRIVERS_SENSOR_SCHED_H__
+#define __PI_DRIVERS_SENSOR_SCHED_H__
+
+#include "pmsis/pmsis_types.h"
+#include "pmsis/drivers/i2c.h"
+
+/**
+ * @ingroup groupDrivers
+ */
+
+/**
+ * @defgroup SensorSched Sensor polling scheduler
+ *
+ * The sensor scheduler periodically reads registers of several I2C or SPI
+ * devices and stores the timestamped values in a ring buffer.
+ *
+ * Each sensor is described by the bus device it is connected to, a list of
+ * registers to read and a period. The scheduler uses a single timer for all
+ * the sensors: the periods are rounded to a multiple of the scheduler tick,
+ * and all the sensors due at the same tick on the same bus are read
+ * back-to-back in a single driver pass (using pi_i2c_transfer for I2C
+ * devices), which reduces the number of fabric controller wakeups and keeps
+ * the sampling regular.
+ *
+ * The application is notified once a configurable number of samples is
+ * available, and can then read them from the ring buffer.
+ */
+
+/**
+ * @addtogroup SensorSched
+ * @{
+ */
+
+/**@{*/
+
+/** \enum pi_sensor_bus_e
+ * \brief Bus type of a sensor.
+ */
+typedef enum {
+  PI_SENSOR_BUS_I2C = 0,  /*!< The sensor is an opened I2C device. */
+  PI_SENSOR_BUS_SPI = 1   /*!< The sensor is an opened SPI device. */
+} pi_sensor_bus_e;
+
+/** \struct pi_sensor_reg
+ * \brief Sensor register descriptor.
+ *
+ * This describes a block of consecutive registers to be read at each period.
+ */
+struct pi_sensor_reg
+{
+    uint32_t addr;      /*!< Register address, sent MSB first. */
+    uint8_t addr_size;  /*!< Size in bytes of the register address. */
+    uint8_t size;       /*!< Number of bytes to read from this address. */
+};
+
+/** \struct pi_sensor_conf
+ * \brief Sensor configuration structure.
+ */
+struct pi_sensor_conf
+{
+    struct pi_device *bus;              /*!< Opened I2C or SPI device of the
+      sensor. Several sensors can share the same bus. */
+    pi_sensor_bus_e bus_type;           /*!< Bus type. */
+    const struct pi_sensor_reg *regs;   /*!< Array of register blocks read at
+      each period. It must be kept alive until the sensor is removed. */
+    uint8_t nb_regs;                    /*!< Number of register blocks. */
+    uint8_t spi_read_mask;              /*!< For SPI sensors, mask ORed into the
+      first byte of the register address to select a read, e.g. 0x80. */
+    uint32_t period_us;                 /*!< Sampling period in
+      micro-seconds. It is rounded to the closest multiple of the scheduler
+      tick. */
+    uint32_t phase_us;                  /*!< Delay of the first sample after
+      the scheduler is started, which can be used to spread the sensors over
+      several ticks. */
+};
+
+/** \struct pi_sensor_sched_conf
+ * \brief Sensor scheduler configuration structure.
+ */
+struct pi_sensor_sched_conf
+{
+    void *ring;             /*!< Buffer used to store the samples. It must be
+      4 bytes aligned and kept alive until the scheduler is closed. */
+    uint32_t ring_size;     /*!< Size in bytes of the ring buffer. */
+    uint32_t tick_us;       /*!< Scheduler tick in micro-seconds. All sensors
+      due within the same tick are read together. */
+    uint32_t notif_threshold; /*!< Number of samples in the ring after which
+      the notification task is pushed. */
+    pi_task_t *notif_task;  /*!< Task pushed when notif_threshold samples are
+      available, or NULL. It must be reinitialized before calling
+      pi_sensor_sched_read so that it can be pushed again. */
+};
+
+/** \struct pi_sensor_sample
+ * \brief Sample header.
+ *
+ * This is filled by pi_sensor_sched_read to describe the sample.
+ */
+struct pi_sensor_sample
+{
+    uint32_t timestamp_us;  /*!< Time in micro-seconds, as returned by
+      pi_time_get_us, when the bus transfer of the sample ended. */
+    uint8_t sensor_id;      /*!< Identifier returned by pi_sensor_sched_add. */
+    int8_t status;          /*!< 0 if the registers were read successfully,
+      otherwise the bus error, e.g. a value of pi_i2c_status_e. */
+    uint16_t size;          /*!< Number of data bytes of the sample, which is
+      the sum of the sizes of the register blocks. */
+};
+
+/** \struct pi_sensor_stats
+ * \brief Sensor statistics.
+ *
+ * The jitter is the difference between the actual time of a sample and its
+ * ideal time computed from the first sample and the period.
+ */
+struct pi_sensor_stats
+{
+    uint32_t nb_samples;    /*!< Number of samples stored in the ring. */
+    uint32_t nb_errors;     /*!< Number of samples whose transfer failed. */
+    uint32_t nb_dropped;    /*!< Number of samples dropped because the ring
+      was full. */
+    uint32_t nb_late;       /*!< Number of periods skipped because the bus was
+      still busy with previous transfers. */
+    int32_t jitter_min_us;  /*!< Minimum jitter in micro-seconds. */
+    int32_t jitter_max_us;  /*!< Maximum jitter in micro-seconds. */
+    uint32_t bus_time_us;   /*!< Total bus time in micro-seconds used for this
+      sensor. */
+};
+
+/** \brief Sensor scheduler structure.
+ *
+ * This structure is used by the runtime to manage a scheduler. It must be
+ * allocated by the caller and kept alive until the scheduler is closed.
+ */
+typedef struct pi_sensor_sched_s pi_sensor_sched_t;
+
+/** \brief Sensor structure.
+ *
+ * This structure is used by the runtime to manage a sensor. It must be
+ * allocated by the caller and kept alive until the sensor is removed.
+ */
+typedef struct pi_sensor_s pi_sensor_t;
+
+/** \brief Initialize a scheduler configuration with default values.
+ *
+ * \param conf           A pointer to the scheduler configuration.
+ */
+void pi_sensor_sched_conf_init(struct pi_sensor_sched_conf *conf);
+
+/** \brief Initialize a sensor configuration with default values.
+ *
+ * \param conf           A pointer to the sensor configuration.
+ */
+void pi_sensor_conf_init(struct pi_sensor_conf *conf);
+
+/** \brief Open a sensor scheduler.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ * \param conf           A pointer to the scheduler configuration. It can be
+ *   released once this function returns.
+ *
+ * \retval 0             If the operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ */
+int pi_sensor_sched_open(pi_sensor_sched_t *sched,
+                         struct pi_sensor_sched_conf *conf);
+
+/** \brief Close a sensor scheduler.
+ *
+ * The scheduler is stopped if needed and all its sensors are removed.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ */
+void pi_sensor_sched_close(pi_sensor_sched_t *sched);
+
+/** \brief Add a sensor to the scheduler.
+ *
+ * This can be called while the scheduler is running, in which case the
+ * sensor is first sampled after its phase has elapsed.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ * \param sensor         A pointer to the sensor structure.
+ * \param conf           A pointer to the sensor configuration. It can be
+ *   released once this function returns.
+ *
+ * \return               The sensor identifier, which is reported in the
+ *   samples, or -1 if the sensor could not be added.
+ */
+int pi_sensor_sched_add(pi_sensor_sched_t *sched, pi_sensor_t *sensor,
+                        struct pi_sensor_conf *conf);
+
+/** \brief Remove a sensor from the scheduler.
+ *
+ * The caller is blocked until the pending transfer of the sensor, if any, is
+ * finished. The samples already in the ring are kept.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ * \param sensor         A pointer to the sensor structure.
+ */
+void pi_sensor_sched_remove(pi_sensor_sched_t *sched, pi_sensor_t *sensor);
+
+/** \brief Start sampling.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ */
+void pi_sensor_sched_start(pi_sensor_sched_t *sched);
+
+/** \brief Stop sampling.
+ *
+ * The caller is blocked until the pending transfers are finished.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ */
+void pi_sensor_sched_stop(pi_sensor_sched_t *sched);
+
+/** \brief Read the oldest sample from the ring.
+ *
+ * This does not block: it returns immediately if the ring is empty.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ * \param sample         A pointer to the structure where the sample header is
+ *   stored.
+ * \param data           Buffer where the sample data is copied.
+ * \param size           Size in bytes of the data buffer. If it is too small,
+ *   the data is truncated.
+ *
+ * \retval 0             If a sample was read.
+ * \retval -1            If the ring is empty.
+ */
+int pi_sensor_sched_read(pi_sensor_sched_t *sched,
+                         struct pi_sensor_sample *sample, void *data,
+                         uint32_t size);
+
+/** \brief Get the statistics of a sensor.
+ *
+ * \param sched          A pointer to the scheduler structure.
+ * \param sensor         A pointer to the sensor structure.
+ * \param stats          A pointer to the structure where the statistics are
+ *   stored.
+ * \param reset          1 to reset the statistics after they are read.
+ */
+void pi_sensor_sched_stats_get(pi_sensor_sched_t *sched, pi_sensor_t *sensor,
+                               struct pi_sensor_stats *stats, int reset);
+
+//!@}
+
+/**
+ * @} end of SensorSched
+ */
+
+
+
+/// @cond IMPLEM
+
+struct pi_sensor_s
+{
+    struct pi_sensor_s *next;
+    struct pi_sensor_conf conf;
+    struct pi_sensor_stats stats;
+    uint32_t next_tick;
+    uint32_t period_ticks;
+    uint32_t first_timestamp;
+    uint32_t nb_periods;
+    uint16_t sample_size;
+    uint8_t id;
+};
+
+struct pi_sensor_sched_s
+{
+    struct pi_sensor_s *sensors;
+    struct pi_sensor_sched_conf conf;
+    uint32_t tick;
+    uint32_t ring_head;
+    uint32_t ring_tail;
+    uint32_t nb_pending;
+    uint8_t next_id;
+    uint8_t running;
+};
+
+/// @endcond
+
+#endif  /* __PI_DRIVERS_SENSOR_SCHED_H__ */
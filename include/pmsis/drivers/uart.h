@@ -339,6 +339,269 @@ int pi_uart_read_async(struct pi_device *device, void *buffer, uint32_t size,
  */
 int pi_uart_write_byte_async(struct pi_device *device, uint8_t *byte, pi_task_t* callback);
 
+/**
+ * \struct pi_uart_rx_ring_conf
+ *
+ * \brief UART continuous reception configuration structure.
+ *
+ * This structure is used to configure the continuous reception of a UART
+ * device into a ring buffer.
+ */
+struct pi_uart_rx_ring_conf
+{
+    void *buffer;           /*!< Ring buffer receiving the data. It must be
+                              kept alive until reception is stopped. */
+    uint32_t size;          /*!< Size of the ring buffer in bytes. It must be
+                              a multiple of 4 bytes. */
+    uint32_t idle_bits;     /*!< Number of bit periods without any received
+                              byte after which the line is considered idle
+                              and the notification task is pushed. 0 to
+                              disable idle-line detection. */
+    uint8_t delimiter;      /*!< Byte value which triggers the notification
+                              task when it is received, e.g. '\n' for AT
+                              commands. */
+    uint8_t delimiter_en;   /*!< 1 to push the notification task when the
+                              delimiter is received, 0 to disable it. */
+    uint32_t threshold;     /*!< Number of bytes available in the ring after
+                              which the notification task is pushed. 0 to
+                              disable it. */
+    pi_task_t *task;        /*!< Notification task, or NULL. It is pushed once
+                              for the first event and must be given again with
+                              pi_uart_rx_ring_notif_set to be notified of the
+                              following ones. */
+};
+
+/**
+ * \struct pi_uart_rx_ring_stats
+ *
+ * \brief UART continuous reception statistics.
+ */
+struct pi_uart_rx_ring_stats
+{
+    uint32_t received;      /*!< Number of bytes received. */
+    uint32_t overflows;     /*!< Number of bytes lost because the ring was
+                              full. */
+    uint32_t max_level;     /*!< Maximum number of bytes waiting in the ring. */
+};
+
+/**
+ * \brief Initialize a UART continuous reception configuration.
+ *
+ * This function can be called to get default values for all parameters before
+ * setting some of them. By default, no notification is enabled.
+ *
+ * \param conf           Pointer to the continuous reception configuration.
+ */
+void pi_uart_rx_ring_conf_init(struct pi_uart_rx_ring_conf *conf);
+
+/**
+ * \brief Start continuous reception.
+ *
+ * This starts receiving data continuously into the ring buffer with UDMA, so
+ * that no byte is lost between 2 reads and the core is not interrupted for
+ * each byte. The application is notified only on the configured events (idle
+ * line, delimiter or threshold), which allows handling variable-length
+ * messages with a few wakeups per message, and then reads the received bytes
+ * with pi_uart_stream_read.
+ * pi_uart_read and its variants must not be used while continuous reception
+ * is active.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param conf           Pointer to the continuous reception configuration. It
+ *                       can be released once this function returns.
+ *
+ * \retval 0             If operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ */
+int pi_uart_rx_ring_start(struct pi_device *device,
+                          struct pi_uart_rx_ring_conf *conf);
+
+/**
+ * \brief Stop continuous reception.
+ *
+ * The bytes still in the ring are discarded.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ */
+void pi_uart_rx_ring_stop(struct pi_device *device);
+
+/**
+ * \brief Set the notification task of continuous reception.
+ *
+ * This gives the task to be pushed on the next configured event. If an event
+ * already happened since the last notification, the task is pushed
+ * immediately.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param task           Notification task, or NULL to remove it.
+ */
+void pi_uart_rx_ring_notif_set(struct pi_device *device, pi_task_t *task);
+
+/**
+ * \brief Get the number of bytes available in the ring.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ *
+ * \return               Number of bytes which can be read without blocking.
+ */
+uint32_t pi_uart_rx_ring_available(struct pi_device *device);
+
+/**
+ * \brief Read received data from the ring.
+ *
+ * This copies up to size bytes from the ring and frees them. It never blocks
+ * and returns the number of bytes actually read, which is 0 if the ring is
+ * empty.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param buffer         Pointer to data buffer.
+ * \param size           Maximum number of bytes to read.
+ *
+ * \return               Number of bytes read.
+ */
+uint32_t pi_uart_stream_read(struct pi_device *device, void *buffer,
+                             uint32_t size);
+
+/**
+ * \brief Read received data from the ring up to a delimiter.
+ *
+ * This is similar to pi_uart_stream_read, but stops after the first
+ * occurrence of the delimiter byte, which is included in the data read.
+ * If the delimiter is not in the ring, nothing is read as long as the ring
+ * holds fewer than size bytes, so that a partial message stays in the ring
+ * until it is complete.
+ * If the buffer fills before the delimiter, i.e. there are at least size
+ * bytes before it or without it in the ring, exactly size bytes are read and
+ * size is returned. The caller can tell this case from a complete message by
+ * checking that the last byte read is not the delimiter, and read the rest of
+ * the message with the next calls.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param buffer         Pointer to data buffer.
+ * \param size           Maximum number of bytes to read.
+ * \param delimiter      Byte value ending the message.
+ *
+ * \return               Number of bytes read, including the delimiter, or
+ *                       size if the buffer filled before the delimiter, or 0
+ *                       if no complete message is available.
+ */
+uint32_t pi_uart_stream_read_until(struct pi_device *device, void *buffer,
+                                   uint32_t size, uint8_t delimiter);
+
+/**
+ * \brief Get continuous reception statistics.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param stats          Pointer to the structure where the statistics are
+ *                       stored.
+ */
+void pi_uart_rx_ring_stats_get(struct pi_device *device,
+                               struct pi_uart_rx_ring_stats *stats);
+
+/**
+ * \struct pi_uart_tx_ring_stats
+ *
+ * \brief UART buffered transmission statistics.
+ */
+struct pi_uart_tx_ring_stats
+{
+    uint32_t written;       /*!< Number of bytes accepted in the ring. */
+    uint32_t rejected;      /*!< Number of bytes refused because the ring was
+                              full. */
+    uint32_t transfers;     /*!< Number of UDMA transfers used to send the
+                              accepted bytes. */
+    uint32_t max_level;     /*!< Maximum number of bytes waiting in the ring. */
+};
+
+/**
+ * \brief Start buffered transmission.
+ *
+ * This attaches a ring buffer to the TX side of the UART. Data given to
+ * pi_uart_write_buffered is copied into the ring, so that the caller does not
+ * have to keep its buffer alive and is never blocked by the line speed.
+ * The ring is sent with UDMA in the background: when a transfer ends, all the
+ * bytes written in the meantime are sent with a single new transfer, so that
+ * several small writes, like log lines, are merged together.
+ * pi_uart_write and its variants can still be used, their data is sent after
+ * the bytes already in the ring.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param buffer         Ring buffer. It must be kept alive until buffered
+ *                       transmission is stopped.
+ * \param size           Size of the ring buffer in bytes.
+ *
+ * \retval 0             If operation is successfull.
+ * \retval ERRNO         An error code otherwise.
+ */
+int pi_uart_tx_ring_start(struct pi_device *device, void *buffer,
+                          uint32_t size);
+
+/**
+ * \brief Stop buffered transmission.
+ *
+ * The caller is blocked until all the bytes in the ring have been sent.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ */
+void pi_uart_tx_ring_stop(struct pi_device *device);
+
+/**
+ * \brief Write data to an UART through the TX ring.
+ *
+ * This copies the data into the TX ring and returns immediately. It can be
+ * called from interrupt handlers. If there is not enough room in the ring,
+ * only the first bytes which fit are copied and the caller can decide to
+ * retry, wait with pi_uart_tx_ring_flush or drop the rest.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param buffer         Pointer to data buffer.
+ * \param size           Size of data to copy in bytes.
+ *
+ * \return               Number of bytes accepted in the ring.
+ */
+uint32_t pi_uart_write_buffered(struct pi_device *device, const void *buffer,
+                                uint32_t size);
+
+/**
+ * \brief Get the free space of the TX ring.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ *
+ * \return               Number of bytes which can be written without being
+ *                       rejected.
+ */
+uint32_t pi_uart_tx_ring_free(struct pi_device *device);
+
+/**
+ * \brief Wait until the TX ring is empty.
+ *
+ * The caller is blocked until all the bytes written so far have been sent.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ */
+void pi_uart_tx_ring_flush(struct pi_device *device);
+
+/**
+ * \brief Be notified when the TX ring is empty.
+ *
+ * This is the asynchronous version of pi_uart_tx_ring_flush. The task is
+ * pushed once all the bytes written so far have been sent.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param task           Event task used to notify the end of transfer.
+ */
+void pi_uart_tx_ring_flush_async(struct pi_device *device, pi_task_t *task);
+
+/**
+ * \brief Get buffered transmission statistics.
+ *
+ * \param device         Pointer to device descriptor of the UART device.
+ * \param stats          Pointer to the structure where the statistics are
+ *                       stored.
+ */
+void pi_uart_tx_ring_stats_get(struct pi_device *device,
+                               struct pi_uart_tx_ring_stats *stats);
+
 
 /**
  * \brief Write data to an UART from cluster side.
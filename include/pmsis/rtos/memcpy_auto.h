@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_RTOS_MEMCPY_AUTO_H__
+#define __PMSIS_RTOS_MEMCPY_AUTO_H__
+
+#include "pmsis/pmsis_types.h"
+#include "pmsis/drivers/dmacpy.h"
+
+/**
+* @ingroup groupRTOS
+*/
+
+/**
+ * @defgroup MemcpyAuto Copy engine selection
+ *
+ * pi_memcpy_auto and pi_memset_auto can be used instead of memcpy and memset
+ * to use the fastest engine available for each copy:
+ * - the calling core, which is the fastest for small copies.
+ * - the UDMA memory copy (see DMACPY), from the fabric controller, between
+ *   FC L1 and L2 memories or inside L2 memory.
+ * - the cluster DMA, from the cluster, between cluster L1 memory and the
+ *   other memories.
+ *
+ * The engine is chosen from the memory regions of the source and the
+ * destination, the calling side (fabric controller or cluster) and the size.
+ * On the fabric controller, the UDMA memory copy is used from the CPU
+ * threshold of the DMACPY device, returned by pi_dmacpy_cpu_threshold_get, so
+ * that it is configured or measured only once, when the device is opened.
+ * On the cluster, a calibration table gives, for each combination of regions,
+ * the size from which the cluster DMA is faster than the core. This table can
+ * be measured on the target with pi_memcpy_auto_calibrate, printed and then
+ * installed at startup with pi_memcpy_auto_calib_set, so that the measurement
+ * is done once per chip. A default table is used otherwise.
+ */
+
+/**
+ * @addtogroup MemcpyAuto
+ * @{
+ */
+
+/**@{*/
+
+/**
+ * @brief Memory regions.
+ */
+typedef enum
+{
+    PI_MEM_REGION_FC_L1 = 0,    /*!< Fabric controller L1 memory. */
+    PI_MEM_REGION_L2    = 1,    /*!< L2 memory. */
+    PI_MEM_REGION_CL_L1 = 2,    /*!< Cluster L1 memory. */
+    PI_MEM_REGION_OTHER = 3,    /*!< Any other memory, e.g. peripheral
+      registers, only copied by the core. */
+    PI_MEM_REGION_NB    = 4     /*!< Number of memory regions. */
+} pi_mem_region_e;
+
+/**
+ * @brief Copy engines.
+ */
+typedef enum
+{
+    PI_COPY_ENGINE_CPU    = 0,  /*!< Copy done by the calling core. */
+    PI_COPY_ENGINE_DMACPY = 1,  /*!< UDMA memory copy. */
+    PI_COPY_ENGINE_CL_DMA = 2   /*!< Cluster DMA. */
+} pi_copy_engine_e;
+
+/** Threshold meaning that the core is always used. */
+#define PI_MEMCPY_AUTO_CPU_ONLY 0xFFFFFFFF
+
+/**
+ * @brief Cluster calibration table.
+ *
+ * For each source region and destination region, size in bytes from which the
+ * cluster DMA is used instead of the cluster core.
+ * PI_MEMCPY_AUTO_CPU_ONLY is used when the cluster DMA cannot do the copy.
+ */
+struct pi_memcpy_auto_calib
+{
+    uint32_t thresholds[PI_MEM_REGION_NB][PI_MEM_REGION_NB];
+};
+
+/**
+ * @brief Return the memory region of an address.
+ *
+ * @param addr Address to check.
+ *
+ * @return The memory region.
+ */
+static inline pi_mem_region_e pi_mem_region_get(const void *addr);
+
+/**
+ * @brief Set the UDMA memory copy device.
+ *
+ * The UDMA memory copy is only used once an opened device is given, from the
+ * CPU threshold of this device. This must be called from the fabric
+ * controller.
+ *
+ * @param dmacpy Opened DMACPY device, or NULL to stop using it.
+ */
+void pi_memcpy_auto_init(struct pi_device *dmacpy);
+
+/**
+ * @brief Measure the cluster calibration table.
+ *
+ * For each combination of regions supported by the cluster DMA, this times
+ * the copy with a cluster core and with the cluster DMA on sizes from 16 bytes
+ * to 16 Kbytes, and stores the first size for which the cluster DMA is faster.
+ * The measured table is not installed. The fabric controller side is not
+ * measured here, see the DMACPY CPU threshold.
+ * This must be called from the fabric controller. The buffers needed in each
+ * memory region are allocated during the measurement.
+ *
+ * @param cluster Opened cluster device, on which the measurement is done.
+ * @param calib Pointer to the structure where the table is stored.
+ *
+ * @retval 0 If the operation is successfull.
+ * @retval -1 If the buffers could not be allocated.
+ */
+int pi_memcpy_auto_calibrate(struct pi_device *cluster,
+                             struct pi_memcpy_auto_calib *calib);
+
+/**
+ * @brief Install a calibration table.
+ *
+ * @param calib Pointer to the table, which is copied.
+ */
+void pi_memcpy_auto_calib_set(const struct pi_memcpy_auto_calib *calib);
+
+/**
+ * @brief Print a calibration table.
+ *
+ * The table is printed as a C initializer, so that it can be stored in the
+ * application sources for a given chip and installed with
+ * pi_memcpy_auto_calib_set.
+ *
+ * @param calib Pointer to the table.
+ */
+void pi_memcpy_auto_calib_print(const struct pi_memcpy_auto_calib *calib);
+
+/**
+ * @brief Return the engine which would be used for a copy.
+ *
+ * @param dst Pointer to dest buffer.
+ * @param src Pointer to source buffer.
+ * @param size Size of data to copy.
+ *
+ * @return The copy engine.
+ */
+pi_copy_engine_e pi_memcpy_auto_engine(void *dst, const void *src,
+                                       size_t size);
+
+/**
+ * @brief Copy with the fastest engine.
+ *
+ * The copy is synchronous, whatever the engine. If the source and the
+ * destination have different alignments, i.e. (src ^ dst) & 3 is not 0, the
+ * whole copy is done by the core. Otherwise, if the buffers or the size are
+ * not multiples of 4 bytes, the unaligned head and tail are copied by the core
+ * and the rest by the DMA engine. It can be called from the fabric controller
+ * or from the cluster.
+ *
+ * @param dst Pointer to dest buffer.
+ * @param src Pointer to source buffer.
+ * @param size Size of data to copy.
+ *
+ * @return The dest buffer.
+ */
+void *pi_memcpy_auto(void *dst, const void *src, size_t size);
+
+/**
+ * @brief Fill memory with the fastest engine.
+ *
+ * The DMA engines cannot fill memory by themselves: the first bytes are set by
+ * the core and the rest of the buffer is filled by copying these bytes with
+ * copies of increasing size, with the DMA engine when the size is above its
+ * threshold.
+ *
+ * @param dst Pointer to dest buffer.
+ * @param value Value of the bytes.
+ * @param size Size of data to set.
+ *
+ * @return The dest buffer.
+ */
+void *pi_memset_auto(void *dst, int value, size_t size);
+
+//!@}
+
+/**
+ * @}
+ */
+
+#endif  /* __PMSIS_RTOS_MEMCPY_AUTO_H__ */
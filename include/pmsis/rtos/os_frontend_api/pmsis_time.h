@@ -17,6 +17,21 @@
 #ifndef __PMSIS_TIME_H__
 #define __PMSIS_TIME_H__
 
+#include <stdint.h>
+
 void pi_time_wait_us(int time_us);
 
+/**
+ * \brief Return the current time.
+ *
+ * This returns the time elapsed since the system was started, in
+ * micro-seconds. The value wraps around after about 71 minutes, so durations
+ * must be computed with unsigned subtractions.
+ * This can be called from interrupt handlers and is used by the drivers to
+ * timestamp their events.
+ *
+ * \return The current time in micro-seconds.
+ */
+uint32_t pi_time_get_us(void);
+
 #endif  /* __PMSIS_TIME_H__ */
@@ -25,8 +25,10 @@
 #include "stdint.h"
 #include "stdarg.h"
 #include "stdio.h"
+#include "string.h"
 
 #include "pmsis.h"
+#include "pmsis/rtos/pi_ring.h"
 
 /**
  * @brief Log level
@@ -63,6 +65,41 @@ typedef uint8_t pi_log_level_t;
 // Dynamic log level. This global variable must be implemented by PMSIS implementation.
 extern pi_log_level_t dynamic_log_level; // Must be initialized at PI_LOG_DEFAULT_DYNAMIC_LEVEL By default.
 
+/**
+ * @brief Log tags
+ *
+ * Each tag has its own dynamic level, checked with the global dynamic level
+ * before the log arguments are evaluated: a message is logged only if its
+ * level is enabled by both. The global level is a cap for all the tags, so
+ * enabling a verbose level for one component means raising the global level
+ * and lowering the levels of the other tags, which are then not slowed down.
+ * Tags are identified by a small integer ID, and can be given
+ * a name so that their level can be changed by name, e.g. from a shell.
+ * Logs using a tag without ID (PI_LOG_ERR, PI_LOG_WNG, ...) use the tag
+ * PI_LOG_TAG_ID_DEFAULT. Applications can use the IDs from PI_LOG_TAG_ID_USER
+ * to PI_LOG_NB_TAGS - 1 for their own tags, with the PI_LOG_*_ID macros.
+ */
+
+typedef uint8_t pi_log_tag_id_t;
+
+#define PI_LOG_TAG_ID_DEFAULT 0 /*!< Tag of logs without tag ID. */
+#define PI_LOG_TAG_ID_SSBL 1
+#define PI_LOG_TAG_ID_I2S 2
+#define PI_LOG_TAG_ID_INIT 3
+#define PI_LOG_TAG_ID_USER 4 /*!< First tag ID available for applications. */
+
+// Fixed, as the tag arrays below are defined once by the PMSIS implementation.
+#define PI_LOG_NB_TAGS 16
+
+// Per-tag dynamic log levels. This global variable must be implemented by PMSIS implementation.
+// Every entry must be initialized at PI_LOG_TRACE, so that only dynamic_log_level
+// applies by default. A zero-initialized array (PI_LOG_NONE) disables all logs.
+extern pi_log_level_t pi_log_tag_levels[PI_LOG_NB_TAGS];
+// Per-tag names. This global variable must be implemented by PMSIS implementation.
+// The predefined tags must be initialized with their names (SSBL_TAG, I2S_TAG,
+// INIT_TAG), the other entries with NULL.
+extern const char *pi_log_tag_names[PI_LOG_NB_TAGS];
+
 typedef int (*vprintf_like_t)(const char *, va_list);
 // Function pointer used to write log output. This global variable must be implemented by PMSIS implementation.
 extern vprintf_like_t pi_log_vprint_func; // By default: &pi_log_default_vprintf;
@@ -92,6 +129,8 @@ static inline vprintf_like_t pi_log_set_vprintf(vprintf_like_t func)
  *
  * By default, the dynamical log level is set to PI_LOG_DEFAULT_DYNAMIC_LEVEL.
  * This function can be used to set this level.
+ * This level caps the level of every tag, the levels set with
+ * pi_log_set_tag_level are kept.
  * Returns the original dynamic log level.
  *
  * @param level new level used for log level.
@@ -105,6 +144,79 @@ static inline pi_log_level_t pi_log_set_dynamic_level(pi_log_level_t level)
     return old;
 }
 
+/**
+ * @brief Set the log level of a tag.
+ *
+ * Messages of this tag are logged only if their level is also enabled by the
+ * global dynamic level.
+ *
+ * @param id Tag ID.
+ * @param level new level used for this tag.
+ *
+ * @return level old level of this tag, or PI_LOG_NONE if the ID is invalid.
+ */
+static inline pi_log_level_t pi_log_set_tag_level(pi_log_tag_id_t id, pi_log_level_t level)
+{
+    if (id >= PI_LOG_NB_TAGS)
+        return PI_LOG_NONE;
+
+    pi_log_level_t old = pi_log_tag_levels[id];
+    pi_log_tag_levels[id] = level;
+    return old;
+}
+
+/**
+ * @brief Get the log level of a tag.
+ *
+ * @param id Tag ID.
+ *
+ * @return the dynamic log level of this tag, not capped by the global dynamic
+ * level, or PI_LOG_NONE if the ID is invalid, so that nothing is logged with it.
+ */
+static inline pi_log_level_t pi_log_get_tag_level(pi_log_tag_id_t id)
+{
+    if (id >= PI_LOG_NB_TAGS)
+        return PI_LOG_NONE;
+
+    return pi_log_tag_levels[id];
+}
+
+/**
+ * @brief Give a name to a tag.
+ *
+ * This is needed only to find the tag by name with pi_log_tag_find.
+ *
+ * @param id Tag ID, usually from PI_LOG_TAG_ID_USER.
+ * @param name Name of the tag. The string must be kept alive.
+ *
+ * @return 0 if the operation is successful, -1 if the ID is invalid.
+ */
+static inline int pi_log_tag_register(pi_log_tag_id_t id, const char *name)
+{
+    if (id >= PI_LOG_NB_TAGS)
+        return -1;
+
+    pi_log_tag_names[id] = name;
+    return 0;
+}
+
+/**
+ * @brief Find a tag by name.
+ *
+ * @param name Name of the tag.
+ *
+ * @return the tag ID, or -1 if no tag has this name.
+ */
+static inline int pi_log_tag_find(const char *name)
+{
+    for (int i = 0; i < PI_LOG_NB_TAGS; i++)
+    {
+        if (pi_log_tag_names[i] && !strcmp(pi_log_tag_names[i], name))
+            return i;
+    }
+    return -1;
+}
+
 /**
  * @brief Get the current dynamic log level.
  *
@@ -187,48 +299,214 @@ static inline pi_log_level_t pi_log_get_level(void)
  */
 static inline void pi_log_write(pi_log_level_t level, const char *tag, const char *format, ...)
 {
+    (void)tag;
     if(level > dynamic_log_level)
         return;
-    
+
+    va_list list;
+    va_start(list, format);
+    (*pi_log_vprint_func)(format, list);
+    va_end(list);
+}
+
+// Unfiltered version of pi_log_write, used by the macros once they have
+// checked the levels.
+static inline void __pi_log_write(const char *format, ...)
+{
     va_list list;
     va_start(list, format);
     (*pi_log_vprint_func)(format, list);
     va_end(list);
 }
 
-#define PI_LOG(level, tag, fmt, ...) \
-    pi_log_write(level, tag, PI_LOG_FORMAT(level ## _TEXT, fmt), CORE_VARS tag, ##__VA_ARGS__)
+/**
+ * Deferred log
+ *
+ * When PI_LOG_DEFERRED is defined, the PI_LOG_* macros do not format
+ * anything. They only record the level, a format string ID, a timestamp and
+ * the raw arguments into a ring buffer private to the calling core, which
+ * costs a few tens of cycles and can be used in cluster hot loops.
+ * The rings are drained with pi_log_deferred_flush, which sends them in binary
+ * form through pi_log_binary_write_func, and the binary stream is decoded on
+ * the host with tools/pi_log_decode.py and the application ELF file.
+ *
+ * The format strings are stored in the .pi_log_fmt section and their address
+ * is used as ID. By default this section is allocated like .rodata. To keep
+ * it out of the target memory, the linker script must turn it into a
+ * non-allocated section, in which case the IDs are offsets in the section:
+ *
+ *     .pi_log_fmt 0 (INFO) : { KEEP(*(.pi_log_fmt)) }
+ *
+ * NOLOAD must not be used instead, as the strings would not be kept in the ELF
+ * file and the decoder could not read them.
+ * In this mode:
+ * - the tag must be a string literal, as it is merged with the format string.
+ * - at most PI_LOG_DEFERRED_MAX_ARGS arguments can be given. They are
+ *   recorded as 32 bits values, so 64 bits integer arguments (%lld, %llx,
+ *   ...) are truncated to their low 32 bits. Floating-point arguments (%f,
+ *   %e, %g, ...) are rejected at compilation.
+ * - %s arguments must point to constant strings, which the decoder reads from
+ *   the ELF file.
+ *
+ * The rings and the binary stream are described in pi_ring.h. The rings are
+ * allocated by the PMSIS implementation, which chooses their size. The chunks
+ * start with PI_LOG_DEFERRED_MAGIC and contain these records:
+ * - record: PI_LOG_DEFERRED_RECORD(level, nb_args), format string address,
+ *   timestamp, then the arguments.
+ */
+
+#define PI_LOG_DEFERRED_MAGIC 0x474f4c50
+#define PI_LOG_DEFERRED_MAX_ARGS 8
+#define PI_LOG_DEFERRED_RECORD(level, nb_args) (0xA5000000 | ((level) << 8) | (nb_args))
+
+typedef int (*pi_log_binary_write_t)(const void *, uint32_t);
+// Function used to output the deferred log. This global variable must be implemented by PMSIS implementation.
+extern pi_log_binary_write_t pi_log_binary_write_func;
+
+/**
+ * @brief Set function used to output deferred log chunks
+ *
+ * @param func new Function used for output. It receives a buffer and its size
+ * in bytes.
+ *
+ * @return func old Function used for output.
+ */
+static inline pi_log_binary_write_t pi_log_set_binary_write(pi_log_binary_write_t func)
+{
+    pi_log_binary_write_t old = pi_log_binary_write_func;
+    pi_log_binary_write_func = func;
+    return old;
+}
+
+/**
+ * @brief Send the content of all deferred log rings
+ *
+ * This must be called regularly from the fabric controller, for example from
+ * an idle task or a periodic callback, to empty the rings.
+ *
+ * @return the number of records sent.
+ */
+int pi_log_deferred_flush(void);
+
+#ifdef PI_LOG_DEFERRED
+
+// Must be implemented by PMSIS implementation: return the ring of the calling core.
+static inline pi_ring_t *pi_log_deferred_ring(void);
+
+// Must be implemented by PMSIS implementation: return a cheap free-running timestamp.
+static inline uint32_t pi_log_deferred_timestamp(void);
+
+/**
+ * @brief Record a message into the deferred log
+ *
+ * This function is not intended to be used directly. Instead, use one of
+ * PI_LOG_ERR, PI_LOG_WNG, PI_LOG_INF, PI_LOG_DBG, PI_LOG_TRC macros.
+ */
+static inline void pi_log_deferred_write(pi_log_level_t level, const char *format,
+                                         uint32_t nb_args, const uint32_t *args)
+{
+    pi_ring_t *ring = pi_log_deferred_ring();
+    uint32_t head;
+
+    if (pi_ring_reserve(ring, 3 + nb_args, &head))
+        return;
+
+    pi_ring_push(ring, &head, PI_LOG_DEFERRED_RECORD(level, nb_args));
+    pi_ring_push(ring, &head, (uint32_t)(uintptr_t)format);
+    pi_ring_push(ring, &head, pi_log_deferred_timestamp());
+    for (uint32_t i = 0; i < nb_args; i++)
+    {
+        pi_ring_push(ring, &head, args[i]);
+    }
+
+    pi_ring_commit(ring, head);
+}
+
+// Argument counting and conversion, up to PI_LOG_DEFERRED_MAX_ARGS.
+// Arguments are recorded as 32 bits words, which cannot carry a double, and
+// the decoder has no way to tell a float from an integer, so floating-point
+// arguments are rejected here instead of being silently garbled.
+#define __PI_LOG_NARGS(...) __PI_LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __PI_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define __PI_LOG_ARG(x) \
+    ((uint32_t)(uintptr_t)(x) + 0 * sizeof(struct { \
+        _Static_assert(__builtin_classify_type(x) != 8, \
+                       "floating-point arguments are not supported by the deferred log"); \
+        int __pi_log_arg; }))
+#define __PI_LOG_ARGS_0()
+#define __PI_LOG_ARGS_1(a) __PI_LOG_ARG(a)
+#define __PI_LOG_ARGS_2(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_1(__VA_ARGS__)
+#define __PI_LOG_ARGS_3(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_2(__VA_ARGS__)
+#define __PI_LOG_ARGS_4(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_3(__VA_ARGS__)
+#define __PI_LOG_ARGS_5(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_4(__VA_ARGS__)
+#define __PI_LOG_ARGS_6(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_5(__VA_ARGS__)
+#define __PI_LOG_ARGS_7(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_6(__VA_ARGS__)
+#define __PI_LOG_ARGS_8(a, ...) __PI_LOG_ARG(a), __PI_LOG_ARGS_7(__VA_ARGS__)
+#define __PI_LOG_ARGS__(n, ...) __PI_LOG_ARGS_ ## n(__VA_ARGS__)
+#define __PI_LOG_ARGS_(n, ...) __PI_LOG_ARGS__(n, ##__VA_ARGS__)
+#define __PI_LOG_ARGS(...) __PI_LOG_ARGS_(__PI_LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+#define __PI_LOG_EMIT(level, letter, tag, fmt, ...) \
+    ({ \
+        static const char __pi_log_fmt[] \
+            __attribute__((section(".pi_log_fmt"), used)) = tag ": " fmt; \
+        const uint32_t __pi_log_args[] = { 0, __PI_LOG_ARGS(__VA_ARGS__) }; \
+        pi_log_deferred_write(level, __pi_log_fmt, \
+                              __PI_LOG_NARGS(__VA_ARGS__), &__pi_log_args[1]); \
+    })
+
+#else // PI_LOG_DEFERRED
+
+#define __PI_LOG_EMIT(level, letter, tag, fmt, ...) \
+    __pi_log_write(PI_LOG_FORMAT(letter, fmt), CORE_VARS tag, ##__VA_ARGS__)
+
+#endif // PI_LOG_DEFERRED
+
+// The levels are checked before anything else is evaluated. This is a void
+// expression, like the pi_log_write call PI_LOG used to be.
+#define __PI_LOG_CHECK(level, letter, id, tag, fmt, ...) \
+    ((level) <= dynamic_log_level && (level) <= pi_log_get_tag_level(id) ? \
+        (void)__PI_LOG_EMIT(level, letter, tag, fmt, ##__VA_ARGS__) : (void)0)
+
+#define PI_LOG_ID(level, id, tag, fmt, ...) __PI_LOG_CHECK(level, level ## _TEXT, id, tag, fmt, ##__VA_ARGS__)
+
+#define PI_LOG(level, tag, fmt, ...) __PI_LOG_CHECK(level, level ## _TEXT, PI_LOG_TAG_ID_DEFAULT, tag, fmt, ##__VA_ARGS__)
 
 
 #if PI_LOG_LOCAL_LEVEL >= PI_LOG_ERROR
-#define PI_LOG_ERR(tag, fmt, ...) PI_LOG(PI_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define PI_LOG_ERR_ID(id, tag, fmt, ...) PI_LOG_ID(PI_LOG_ERROR, id, tag, fmt, ##__VA_ARGS__)
 #else // Error
-#define PI_LOG_ERR(tag, fmt, ...)
+#define PI_LOG_ERR_ID(id, tag, fmt, ...)
 #endif
+#define PI_LOG_ERR(tag, fmt, ...) PI_LOG_ERR_ID(PI_LOG_TAG_ID_DEFAULT, tag, fmt, ##__VA_ARGS__)
 
 #if PI_LOG_LOCAL_LEVEL >= PI_LOG_WARNING
-#define PI_LOG_WNG(tag, fmt, ...) PI_LOG(PI_LOG_WARNING, tag, fmt, ##__VA_ARGS__)
+#define PI_LOG_WNG_ID(id, tag, fmt, ...) PI_LOG_ID(PI_LOG_WARNING, id, tag, fmt, ##__VA_ARGS__)
 #else // Warning
-#define PI_LOG_WNG(tag, fmt, ...)
+#define PI_LOG_WNG_ID(id, tag, fmt, ...)
 #endif
+#define PI_LOG_WNG(tag, fmt, ...) PI_LOG_WNG_ID(PI_LOG_TAG_ID_DEFAULT, tag, fmt, ##__VA_ARGS__)
 
 #if PI_LOG_LOCAL_LEVEL >= PI_LOG_INFO
-#define PI_LOG_INF(tag, fmt, ...) PI_LOG(PI_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define PI_LOG_INF_ID(id, tag, fmt, ...) PI_LOG_ID(PI_LOG_INFO, id, tag, fmt, ##__VA_ARGS__)
 #else // Info
-#define PI_LOG_INF(tag, fmt, ...)
+#define PI_LOG_INF_ID(id, tag, fmt, ...)
 #endif
+#define PI_LOG_INF(tag, fmt, ...) PI_LOG_INF_ID(PI_LOG_TAG_ID_DEFAULT, tag, fmt, ##__VA_ARGS__)
 
 #if PI_LOG_LOCAL_LEVEL >= PI_LOG_DEBUG
-#define PI_LOG_DBG(tag, fmt, ...) PI_LOG(PI_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define PI_LOG_DBG_ID(id, tag, fmt, ...) PI_LOG_ID(PI_LOG_DEBUG, id, tag, fmt, ##__VA_ARGS__)
 #else // Info
-#define PI_LOG_DBG(tag, fmt, ...)
+#define PI_LOG_DBG_ID(id, tag, fmt, ...)
 #endif
+#define PI_LOG_DBG(tag, fmt, ...) PI_LOG_DBG_ID(PI_LOG_TAG_ID_DEFAULT, tag, fmt, ##__VA_ARGS__)
 
 #if PI_LOG_LOCAL_LEVEL >= PI_LOG_TRACE
-#define PI_LOG_TRC(tag, fmt, ...) PI_LOG(PI_LOG_TRACE, tag, fmt, ##__VA_ARGS__)
+#define PI_LOG_TRC_ID(id, tag, fmt, ...) PI_LOG_ID(PI_LOG_TRACE, id, tag, fmt, ##__VA_ARGS__)
 #else // Trace
-#define PI_LOG_TRC(tag, fmt, ...)
+#define PI_LOG_TRC_ID(id, tag, fmt, ...)
 #endif
+#define PI_LOG_TRC(tag, fmt, ...) PI_LOG_TRC_ID(PI_LOG_TAG_ID_DEFAULT, tag, fmt, ##__VA_ARGS__)
 
 /**
  * @brief Function used by default to write log throught vprintf.
@@ -259,24 +537,24 @@ static inline int pi_log_default_vprintf(const char *format, va_list list)
  * Module macros
  */
 #define SSBL_TAG "ssbl"
-#define SSBL_ERR(fmt, ...) PI_LOG_ERR(SSBL_TAG, fmt, ##__VA_ARGS__)
-#define SSBL_WNG(fmt, ...) PI_LOG_WNG(SSBL_TAG, fmt, ##__VA_ARGS__)
-#define SSBL_INF(fmt, ...) PI_LOG_INF(SSBL_TAG, fmt, ##__VA_ARGS__)
-#define SSBL_DBG(fmt, ...) PI_LOG_DBG(SSBL_TAG, fmt, ##__VA_ARGS__)
-#define SSBL_TRC(fmt, ...) PI_LOG_TRC(SSBL_TAG, fmt, ##__VA_ARGS__)
+#define SSBL_ERR(fmt, ...) PI_LOG_ERR_ID(PI_LOG_TAG_ID_SSBL, SSBL_TAG, fmt, ##__VA_ARGS__)
+#define SSBL_WNG(fmt, ...) PI_LOG_WNG_ID(PI_LOG_TAG_ID_SSBL, SSBL_TAG, fmt, ##__VA_ARGS__)
+#define SSBL_INF(fmt, ...) PI_LOG_INF_ID(PI_LOG_TAG_ID_SSBL, SSBL_TAG, fmt, ##__VA_ARGS__)
+#define SSBL_DBG(fmt, ...) PI_LOG_DBG_ID(PI_LOG_TAG_ID_SSBL, SSBL_TAG, fmt, ##__VA_ARGS__)
+#define SSBL_TRC(fmt, ...) PI_LOG_TRC_ID(PI_LOG_TAG_ID_SSBL, SSBL_TAG, fmt, ##__VA_ARGS__)
 
 #define I2S_TAG "i2s"
-#define I2S_ERR(fmt, ...) PI_LOG_ERR(I2S_TAG, fmt, ##__VA_ARGS__)
-#define I2S_WNG(fmt, ...) PI_LOG_WNG(I2S_TAG, fmt, ##__VA_ARGS__)
-#define I2S_INF(fmt, ...) PI_LOG_INF(I2S_TAG, fmt, ##__VA_ARGS__)
-#define I2S_DBG(fmt, ...) PI_LOG_DBG(I2S_TAG, fmt, ##__VA_ARGS__)
-#define I2S_TRC(fmt, ...) PI_LOG_TRC(I2S_TAG, fmt, ##__VA_ARGS__)
+#define I2S_ERR(fmt, ...) PI_LOG_ERR_ID(PI_LOG_TAG_ID_I2S, I2S_TAG, fmt, ##__VA_ARGS__)
+#define I2S_WNG(fmt, ...) PI_LOG_WNG_ID(PI_LOG_TAG_ID_I2S, I2S_TAG, fmt, ##__VA_ARGS__)
+#define I2S_INF(fmt, ...) PI_LOG_INF_ID(PI_LOG_TAG_ID_I2S, I2S_TAG, fmt, ##__VA_ARGS__)
+#define I2S_DBG(fmt, ...) PI_LOG_DBG_ID(PI_LOG_TAG_ID_I2S, I2S_TAG, fmt, ##__VA_ARGS__)
+#define I2S_TRC(fmt, ...) PI_LOG_TRC_ID(PI_LOG_TAG_ID_I2S, I2S_TAG, fmt, ##__VA_ARGS__)
 
 #define INIT_TAG "init"
-#define INIT_ERR(fmt, ...) PI_LOG_ERR(INIT_TAG, fmt, ##__VA_ARGS__)
-#define INIT_WNG(fmt, ...) PI_LOG_WNG(INIT_TAG, fmt, ##__VA_ARGS__)
-#define INIT_INF(fmt, ...) PI_LOG_INF(INIT_TAG, fmt, ##__VA_ARGS__)
-#define INIT_DBG(fmt, ...) PI_LOG_DBG(INIT_TAG, fmt, ##__VA_ARGS__)
-#define INIT_TRC(fmt, ...) PI_LOG_TRC(INIT_TAG, fmt, ##__VA_ARGS__)
+#define INIT_ERR(fmt, ...) PI_LOG_ERR_ID(PI_LOG_TAG_ID_INIT, INIT_TAG, fmt, ##__VA_ARGS__)
+#define INIT_WNG(fmt, ...) PI_LOG_WNG_ID(PI_LOG_TAG_ID_INIT, INIT_TAG, fmt, ##__VA_ARGS__)
+#define INIT_INF(fmt, ...) PI_LOG_INF_ID(PI_LOG_TAG_ID_INIT, INIT_TAG, fmt, ##__VA_ARGS__)
+#define INIT_DBG(fmt, ...) PI_LOG_DBG_ID(PI_LOG_TAG_ID_INIT, INIT_TAG, fmt, ##__VA_ARGS__)
+#define INIT_TRC(fmt, ...) PI_LOG_TRC_ID(PI_LOG_TAG_ID_INIT, INIT_TAG, fmt, ##__VA_ARGS__)
 
 #endif //PI_LOG_H
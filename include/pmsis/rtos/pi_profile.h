@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_RTOS_PI_PROFILE_H__
+#define __PMSIS_RTOS_PI_PROFILE_H__
+
+#include <stdint.h>
+
+#include "pmsis.h"
+// pi_perf_read. The event IDs such as PI_PERF_CYCLES come from the perf.h
+// of the chip, which the OS port includes from pmsis.h.
+#include "pmsis/drivers/perf.h"
+
+/**
+ * @defgroup Profile Region profiler
+ *
+ * The region profiler accumulates the cycles and a few performance events
+ * spent in named regions of code, separately for each core, and can then
+ * print them as a table.
+ *
+ * A region is delimited by the scope in which PI_PROFILE_SCOPE is used:
+ *
+ *     void conv1(void *arg)
+ *     {
+ *         PI_PROFILE_SCOPE("conv1");
+ *         ...
+ *     }
+ *
+ * The same region can be entered by any core, from the fabric controller or
+ * from the cluster, and the counters are kept per core so that the cores of a
+ * team can be compared. Regions can be nested, in which case the outer region
+ * includes the counters of the inner ones.
+ *
+ * The performance counters are never stopped or reset by the profiler: it only
+ * reads them when a region is entered and left and accumulates the
+ * differences. This is what allows using the PI_PERF_CYCLES timer, which is
+ * shared by all the cores of the cluster, from several cores at the same time.
+ * The counters must first be configured on each core with pi_profile_start.
+ *
+ * More events than the hardware can count together can be reported for the
+ * same regions by multiplexing them over several runs of the workload. The
+ * events are split into passes of PI_PROFILE_HW_COUNTERS events, and the
+ * application runs its workload once per pass:
+ *
+ *     pi_profile_conf(events, nb_events);
+ *     for (int pass = 0; pass < pi_profile_nb_passes(); pass++)
+ *     {
+ *         pi_profile_pass_set(pass);
+ *         run_workload();   // Calls pi_profile_start on each core
+ *     }
+ *     pi_profile_dump();
+ *
+ * For each event, the profiler also accumulates the cycles of the region
+ * during which the event was counted, and scales the event count to the total
+ * cycles of the region, see pi_profile_event_scaled. This is exact if the runs
+ * are identical, and an estimation otherwise.
+ *
+ * pi_profile_kernel_analyze gives a per-core view of a cluster kernel, to tune
+ * its L1 memory layout: it reports the instruction cache misses and TCDM bank
+ * conflicts of each core and suggests buffer paddings.
+ *
+ * The region profiler is only compiled in when PI_PROFILE is defined. Otherwise
+ * PI_PROFILE_SCOPE expands to nothing, so that the instrumentation can be kept
+ * in the code at no cost.
+ */
+
+/**
+ * @addtogroup Profile
+ * @{
+ */
+
+/**@{*/
+
+#ifndef PI_PROFILE_HW_COUNTERS
+/** Number of events counted together with the cycles by the hardware. Real
+ * chips have a single performance counter, so one event by default.
+ */
+#define PI_PROFILE_HW_COUNTERS 1
+#endif
+
+#ifndef PI_PROFILE_NB_EVENTS
+/** Maximum number of events reported by the profiler. If it is greater than
+ * PI_PROFILE_HW_COUNTERS, the events are multiplexed over several passes.
+ */
+#define PI_PROFILE_NB_EVENTS PI_PROFILE_HW_COUNTERS
+#endif
+
+#ifndef PI_PROFILE_NB_SLOTS
+/** Number of counter slots per region. Slots 0 to PI_PROFILE_NB_SLOTS - 2 are
+ * used by the cluster cores, identified by their core ID, and the last one by
+ * the fabric controller.
+ */
+#define PI_PROFILE_NB_SLOTS 9
+#endif
+
+/** Slot used by the fabric controller. */
+#define PI_PROFILE_SLOT_FC (PI_PROFILE_NB_SLOTS - 1)
+
+/** \struct pi_profile_counters
+ * \brief Counters accumulated for a region on one core.
+ */
+struct pi_profile_counters
+{
+    uint32_t nb_calls;  /*!< Number of times the region was left. */
+    uint64_t cycles;    /*!< Cycles spent in the region, measured with the
+      PI_PERF_CYCLES timer. */
+    uint64_t events[PI_PROFILE_NB_EVENTS]; /*!< Events counted in the region,
+      in the order given to pi_profile_conf. */
+    uint64_t event_cycles[PI_PROFILE_NB_EVENTS]; /*!< For each event, cycles
+      spent in the region during the passes where the event was counted. */
+};
+
+/** \brief Profiled region.
+ *
+ * This structure is statically allocated by PI_PROFILE_SCOPE for each region.
+ */
+typedef struct pi_profile_region_s pi_profile_region_t;
+
+/** \brief Select the events monitored by the profiler.
+ *
+ * The cycles are always monitored. This must be called before
+ * pi_profile_start and resets the counters of all the regions. The first pass
+ * is selected.
+ *
+ * \param events    Array of performance events, from pi_perf_event_e.
+ * \param nb_events Number of events, at most PI_PROFILE_NB_EVENTS. If it is
+ *   greater than PI_PROFILE_HW_COUNTERS, the events are multiplexed.
+ * \return          0 if the operation is successfull, -1 if there are too
+ *   many events.
+ */
+int pi_profile_conf(const int *events, int nb_events);
+
+/** \brief Return the number of passes needed to count all the events.
+ *
+ * \return The number of events given to pi_profile_conf divided by
+ *   PI_PROFILE_HW_COUNTERS, rounded up, or 1 if there is no event.
+ */
+int pi_profile_nb_passes(void);
+
+/** \brief Select the events counted during the next runs.
+ *
+ * Pass N counts the events N * PI_PROFILE_HW_COUNTERS to
+ * (N + 1) * PI_PROFILE_HW_COUNTERS - 1 of the list given to pi_profile_conf.
+ * The counters of the regions are kept. This must be called while no region is
+ * entered, and pi_profile_start must then be called again on each core.
+ *
+ * \param pass      The pass index, from 0 to pi_profile_nb_passes() - 1.
+ */
+void pi_profile_pass_set(int pass);
+
+/** \brief Start the performance counters on the calling core.
+ *
+ * This configures and starts the performance counters with the events
+ * of the current pass. It must be called on each core which enters
+ * profiled regions, e.g. at the beginning of the team fork entry point for the
+ * cluster cores. The PI_PERF_CYCLES timer is started if needed but never
+ * reset.
+ */
+void pi_profile_start(void);
+
+/** \brief Reset the counters of all the regions.
+ *
+ * This must not be called while a region is entered on another core.
+ */
+void pi_profile_reset(void);
+
+/** \brief Get the counters of a region.
+ *
+ * \param name     Name of the region, as given to PI_PROFILE_SCOPE.
+ * \param slot     Counter slot, i.e. the cluster core ID or
+ *   PI_PROFILE_SLOT_FC.
+ * \param counters A pointer to the structure where the counters are copied.
+ * \return         0 if the operation is successfull, -1 if the region has
+ *   never been entered.
+ */
+int pi_profile_counters_get(const char *name, int slot,
+                            struct pi_profile_counters *counters);
+
+/** \brief Print the counters of all the regions.
+ *
+ * This prints one line per region and per slot where the region was entered,
+ * with the number of calls, the cycles, the average cycles per call and the
+ * events, followed by the total of each region over all the cores. When
+ * events are multiplexed, the scaled values are printed and marked with '*'.
+ */
+void pi_profile_dump(void);
+
+/** \brief Return an event count scaled to the total cycles of the region.
+ *
+ * This estimates the number of events the region would have produced if the
+ * event had been counted during all the passes:
+ *
+ *     events[index] * cycles / event_cycles[index]
+ *
+ * If the event was counted during all the passes, the count is returned
+ * unchanged.
+ *
+ * The product cannot be computed on 64 bits for long runs, so the ratio
+ * cycles / event_cycles is computed first in Q16, which gives a relative
+ * error below 2^-16 on the scaled count. This is valid for any counter values
+ * as long as the ratio is below 2^32, which is always the case when the
+ * passes have similar durations. Otherwise, or if the scaled count does not
+ * fit in 64 bits, UINT64_MAX is returned.
+ *
+ * \param counters  A pointer to the counters of the region.
+ * \param index     Index of the event in the list given to pi_profile_conf.
+ * \return          The scaled event count, or 0 if the event was never
+ *   counted.
+ */
+static inline uint64_t pi_profile_event_scaled(struct pi_profile_counters *counters,
+                                               int index)
+{
+    uint64_t events = counters->events[index];
+    uint64_t cycles = counters->cycles;
+    uint64_t event_cycles = counters->event_cycles[index];
+
+    if (event_cycles == 0)
+        return 0;
+
+    if (event_cycles == cycles)
+        return events;
+
+    // Keep the ratio but make room for the Q16 shift
+    while (cycles >> 48)
+    {
+        cycles >>= 1;
+        event_cycles >>= 1;
+    }
+
+    if (event_cycles == 0)
+        return UINT64_MAX;
+
+    uint64_t ratio = (cycles << 16) / event_cycles;
+    if (ratio >> 48)
+        return UINT64_MAX;
+
+    uint64_t high = events >> 16;
+    uint64_t low = ((events & 0xFFFF) * ratio) >> 16;
+    if (high > (UINT64_MAX - low) / ratio)
+        return UINT64_MAX;
+
+    return high * ratio + low;
+}
+
+/** Maximum number of cores reported by the kernel analysis. */
+#define PI_PROFILE_KERNEL_MAX_CORES 8
+
+/** Maximum number of buffers checked by the kernel analysis. */
+#define PI_PROFILE_KERNEL_MAX_BUFFERS 8
+
+/** \struct pi_profile_kernel_conf
+ * \brief Kernel analysis configuration structure.
+ */
+struct pi_profile_kernel_conf
+{
+    int nb_cores;               /*!< Number of cores of the team fork. If it is
+      zero, the number of cores of the previous fork is used. */
+    uint8_t conflict_ratio;     /*!< A core is flagged when its TCDM contention
+      cycles exceed this percentage of the average over the team, e.g. 150. */
+    uint8_t conflict_min;       /*!< Cores are flagged only when their TCDM
+      contention cycles exceed this percentage of their cycles, so that
+      negligible conflicts are ignored, e.g. 2. */
+    uint8_t tcdm_nb_banks;      /*!< Number of TCDM banks of the cluster. Banks
+      are interleaved on 32 bits words. */
+    uint8_t nb_buffers;         /*!< Number of entries in buffer_strides. */
+    uint32_t buffer_strides[PI_PROFILE_KERNEL_MAX_BUFFERS]; /*!< For each L1
+      buffer accessed in parallel by the cores, the distance in bytes between
+      the parts accessed by 2 consecutive cores at the same time, e.g. the line
+      stride when each core processes its own line. Used to suggest paddings
+      when conflicts are detected. */
+};
+
+/** \struct pi_profile_kernel_core
+ * \brief Counters of one core measured by the kernel analysis.
+ */
+struct pi_profile_kernel_core
+{
+    uint32_t cycles;            /*!< Cycles from the fork to the return of the
+      entry point on this core. */
+    uint32_t imiss;             /*!< PI_PERF_IMISS, cycles waiting for
+      instruction fetches. */
+    uint32_t tcdm_cont;         /*!< PI_PERF_TCDM_CONT, cycles lost in TCDM
+      bank conflicts. */
+};
+
+/** \struct pi_profile_kernel_report
+ * \brief Kernel analysis report.
+ */
+struct pi_profile_kernel_report
+{
+    int nb_cores;               /*!< Number of cores of the team. */
+    uint32_t cycles;            /*!< Cycles of the whole fork, as seen by the
+      cluster controller. */
+    struct pi_profile_kernel_core cores[PI_PROFILE_KERNEL_MAX_CORES]; /*!<
+      Counters per core. */
+    uint32_t conflict_cores;    /*!< Mask of the cores flagged for
+      disproportionate TCDM contention. */
+    uint32_t imiss_cores;       /*!< Mask of the cores whose instruction miss
+      cycles exceed conflict_ratio percent of the team average. */
+    uint32_t paddings[PI_PROFILE_KERNEL_MAX_BUFFERS]; /*!< Suggested padding in
+      bytes to add to each buffer stride, 0 if the stride does not need to be
+      changed. Only filled when cores are flagged for contention. */
+};
+
+/** \brief Initialize a kernel analysis configuration with default values.
+ *
+ * \param conf A pointer to the kernel analysis configuration.
+ */
+void pi_profile_kernel_conf_init(struct pi_profile_kernel_conf *conf);
+
+/** \brief Analyze the instruction cache misses and TCDM conflicts of a kernel.
+ *
+ * This runs the kernel with pi_cl_team_fork once per measured event, as the
+ * cores can count a single event at a time, and collects the counters of each
+ * core. The kernel must therefore produce the same accesses at each run, e.g.
+ * by working on the same input.
+ * The cores whose TCDM contention is disproportionate compared to the rest of
+ * the team are flagged. In this case, a padding is suggested for each buffer
+ * stride which makes the cores access the same banks at the same time, i.e.
+ * which is a multiple of the bank interleaving, so that consecutive cores are
+ * shifted by one bank.
+ * This must be called from the cluster controller core, outside of any team
+ * fork. It uses the performance counters, so it must not be called while the
+ * region profiler is running.
+ *
+ * \param conf   A pointer to the kernel analysis configuration.
+ * \param entry  The kernel entry point, executed by all cores of the team.
+ * \param arg    The argument of the kernel entry point.
+ * \param report A pointer to the structure where the report is stored.
+ * \return       0 if the operation is successfull, -1 if the number of cores
+ *   is greater than PI_PROFILE_KERNEL_MAX_CORES.
+ */
+int pi_profile_kernel_analyze(struct pi_profile_kernel_conf *conf,
+                              void (*entry)(void *), void *arg,
+                              struct pi_profile_kernel_report *report);
+
+/** \brief Print a kernel analysis report.
+ *
+ * This prints the counters of each core, with the percentage of cycles lost
+ * in instruction misses and TCDM conflicts, the flagged cores and the
+ * suggested paddings.
+ *
+ * \param report A pointer to the kernel analysis report.
+ */
+void pi_profile_kernel_report_print(struct pi_profile_kernel_report *report);
+
+#ifdef PI_PROFILE
+
+/** \brief Profile the enclosing scope.
+ *
+ * This declares a variable whose cleanup function accumulates the counters
+ * when the scope is left, including through return or break. It can be used
+ * at most once per line.
+ *
+ * \param region_name A constant string naming the region. Several scopes can
+ *   use the same name, in which case they are reported as different regions.
+ */
+#define PI_PROFILE_SCOPE(region_name) \
+    static pi_profile_region_t __PI_PROFILE_CAT(__pi_profile_region_, __LINE__) = { .name = (region_name) }; \
+    struct pi_profile_scope __PI_PROFILE_CAT(__pi_profile_scope_, __LINE__) \
+        __attribute__((cleanup(__pi_profile_scope_end))) = \
+        __pi_profile_scope_begin(&__PI_PROFILE_CAT(__pi_profile_region_, __LINE__))
+
+#else
+
+#define PI_PROFILE_SCOPE(region_name)
+
+#endif
+
+//!@}
+
+/**
+ * @}
+ */
+
+
+
+/// @cond IMPLEM
+
+#define __PI_PROFILE_CAT2(a, b) a ## b
+#define __PI_PROFILE_CAT(a, b) __PI_PROFILE_CAT2(a, b)
+
+struct pi_profile_region_s
+{
+    const char *name;
+    struct pi_profile_region_s *next;
+    uint8_t registered;
+    struct pi_profile_counters counters[PI_PROFILE_NB_SLOTS];
+};
+
+struct pi_profile_scope
+{
+    pi_profile_region_t *region;
+    uint32_t cycles;
+    uint32_t events[PI_PROFILE_HW_COUNTERS];
+};
+
+// Events selected by pi_profile_conf. These global variables must be implemented by PMSIS implementation.
+extern int __pi_profile_events[PI_PROFILE_NB_EVENTS];
+extern int __pi_profile_nb_events;
+// Events of the current pass, as indexes in __pi_profile_events. These global variables must be implemented by PMSIS implementation.
+extern uint8_t __pi_profile_active[PI_PROFILE_HW_COUNTERS];
+extern int __pi_profile_nb_active;
+
+#ifdef PI_PROFILE
+
+// Adds the region to the list dumped by pi_profile_dump. It must check again
+// the registered flag under a lock, as several cores can enter the region for
+// the first time together.
+void __pi_profile_region_register(pi_profile_region_t *region);
+
+// Returns the counter slot of the calling core. This must be implemented by
+// PMSIS implementation.
+static inline int __pi_profile_slot(void);
+
+static inline struct pi_profile_scope __pi_profile_scope_begin(pi_profile_region_t *region)
+{
+    struct pi_profile_scope scope;
+
+    if (!region->registered)
+    {
+        __pi_profile_region_register(region);
+    }
+
+    scope.region = region;
+    for (int i = 0; i < __pi_profile_nb_active; i++)
+    {
+        scope.events[i] = pi_perf_read(__pi_profile_events[__pi_profile_active[i]]);
+    }
+    // Read last so that the reads of the events are not counted
+    scope.cycles = pi_perf_read(PI_PERF_CYCLES);
+
+    return scope;
+}
+
+static inline void __pi_profile_scope_end(struct pi_profile_scope *scope)
+{
+    // Read first so that the accumulation is not counted. The differences are
+    // computed on 32 bits so that counter wrap-around is handled.
+    uint32_t cycles = pi_perf_read(PI_PERF_CYCLES) - scope->cycles;
+    struct pi_profile_counters *counters = &scope->region->counters[__pi_profile_slot()];
+
+    for (int i = 0; i < __pi_profile_nb_active; i++)
+    {
+        int index = __pi_profile_active[i];
+        counters->events[index] += (uint32_t)(pi_perf_read(__pi_profile_events[index]) - scope->events[i]);
+        counters->event_cycles[index] += cycles;
+    }
+    counters->cycles += cycles;
+    counters->nb_calls++;
+}
+
+#endif
+
+/// @endcond
+
+#endif  /* __PMSIS_RTOS_PI_PROFILE_H__ */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_RTOS_PI_RING_H__
+#define __PMSIS_RTOS_PI_RING_H__
+
+#include <stdint.h>
+
+#include "pmsis.h"
+
+/**
+ * Per-core record ring
+ *
+ * Ring of 32 bits words used by the deferred log and the activity trace to
+ * record events from any core at a low cost. Each core writes into its own
+ * ring and the fabric controller drains all the rings, so a ring has a single
+ * producer and a single consumer.
+ *
+ * The rings are drained into a binary stream of little-endian 32 bits words,
+ * made of one chunk per ring, which is parsed on the host by tools/pi_stream.py:
+ * - chunk header: a magic number identifying the producer, core information
+ *   (see PI_RING_CHUNK_CORE_INFO), number of record words in the chunk,
+ *   number of records dropped because the ring was full since the previous
+ *   chunk, as returned by pi_ring_dropped_take.
+ * - the record words, whose format depends on the producer.
+ */
+
+#define PI_RING_CHUNK_HEADER_SIZE 4 // Chunk header size in words
+
+// Core information word of a chunk header. The fabric controller flag is set
+// for the ring of the fabric controller, whose cluster ID depends on the chip.
+#define PI_RING_CHUNK_FC (1 << 15)
+#define PI_RING_CHUNK_CORE_INFO(cluster_id, core_id, is_fc) \
+    (((cluster_id) << 16) | ((is_fc) ? PI_RING_CHUNK_FC : 0) | (core_id))
+
+/**
+ * @brief Record ring
+ *
+ * head and tail are free-running word counters, only head is written by the
+ * producer core and only tail is written by the consumer, so no lock is needed.
+ * dropped is also a free-running counter written only by the producer, the
+ * consumer keeps in dropped_seen the value it last reported.
+ */
+typedef struct pi_ring
+{
+    uint32_t *buffer;
+    uint32_t size; // Size in words, must be a power of 2
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    uint32_t dropped_seen;
+} pi_ring_t;
+
+/**
+ * @brief Reserve room for a record
+ *
+ * The record is dropped and counted in dropped if the ring does not have
+ * enough free words.
+ *
+ * @param ring Ring of the calling core.
+ * @param nb_words Size of the record in words.
+ * @param head Where the write position of the record is returned.
+ *
+ * @return 0 if the record can be written, -1 if it was dropped.
+ */
+static inline int pi_ring_reserve(pi_ring_t *ring, uint32_t nb_words, uint32_t *head)
+{
+    *head = ring->head;
+
+    if (ring->size - (*head - ring->tail) < nb_words)
+    {
+        ring->dropped++;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Write a word of a reserved record
+ *
+ * @param ring Ring of the calling core.
+ * @param head Write position, incremented.
+ * @param word Word to write.
+ */
+static inline void pi_ring_push(pi_ring_t *ring, uint32_t *head, uint32_t word)
+{
+    ring->buffer[(*head)++ & (ring->size - 1)] = word;
+}
+
+/**
+ * @brief Make a record visible to the consumer
+ *
+ * @param ring Ring of the calling core.
+ * @param head Write position after the last word of the record.
+ */
+static inline void pi_ring_commit(pi_ring_t *ring, uint32_t head)
+{
+    // Record must be complete before the consumer can see it
+    hal_compiler_barrier();
+    ring->head = head;
+}
+
+/**
+ * @brief Get the number of records dropped since the previous call
+ *
+ * This must be called by the consumer, once per chunk. The counter of the
+ * producer is never reset, so drops counted during this call are reported by
+ * the next one.
+ *
+ * @param ring Ring to check.
+ *
+ * @return the number of records dropped since the previous call.
+ */
+static inline uint32_t pi_ring_dropped_take(pi_ring_t *ring)
+{
+    uint32_t dropped = ring->dropped;
+    uint32_t result = dropped - ring->dropped_seen;
+    ring->dropped_seen = dropped;
+    return result;
+}
+
+#endif  /* __PMSIS_RTOS_PI_RING_H__ */
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PMSIS_RTOS_PI_TRACE_H__
+#define __PMSIS_RTOS_PI_TRACE_H__
+
+#include <stdint.h>
+
+#include "pmsis.h"
+#include "pmsis/rtos/pi_ring.h"
+
+/**
+ * @defgroup Trace Activity trace
+ *
+ * The activity trace records timestamped begin and end events of the runtime
+ * activities, so that the concurrency between fabric controller tasks,
+ * cluster tasks, DMA transfers and peripheral transfers can be visualized on
+ * a timeline.
+ *
+ * When PI_TRACE is defined, the runtime records:
+ * - PI_TRACE_CL_TASK: a cluster task, from pi_cluster_send_task or its async
+ *   variant to the end of the task.
+ * - PI_TRACE_CL_FORK: a team fork, on each core of the team, from the entry
+ *   point call to its return.
+ * - PI_TRACE_CL_DMA: a cluster DMA transfer, from pi_cl_dma_memcpy to the
+ *   end of pi_cl_dma_wait.
+ * - PI_TRACE_UDMA: a peripheral transfer, from its enqueue to the end of
+ *   transfer interrupt.
+ * - PI_TRACE_EVENT_CB: an event kernel callback execution.
+ * The application can add its own events with PI_TRACE_USER_BEGIN and
+ * PI_TRACE_USER_END.
+ *
+ * Events are recorded into a ring buffer private to the calling core, which
+ * costs a few tens of cycles. The rings are drained with pi_trace_flush from
+ * the fabric controller, and the binary stream is converted on the host with
+ * tools/pi_trace2json.py into the Chrome trace JSON format, which can be
+ * opened with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * The rings and the binary stream are described in pi_ring.h. The rings are
+ * allocated by the PMSIS implementation, which chooses their size. The chunks
+ * start with PI_TRACE_MAGIC and contain these records:
+ * - record: PI_TRACE_RECORD(type, phase), timestamp, id, argument.
+ *
+ * Begin and end records of the same activity have the same type and id. The
+ * id is the address of the task, copy or callback structure, or the address
+ * of the name string for user events, which the host tool reads from the ELF
+ * file. The timestamps of all the cores come from the same time base, so that
+ * the rings can be merged.
+ */
+
+/**
+ * @addtogroup Trace
+ * @{
+ */
+
+/**@{*/
+
+#define PI_TRACE_MAGIC 0x43525450 /*!< Chunk header magic number. */
+#define PI_TRACE_RECORD(type, phase) (0xA6000000 | ((type) << 8) | (phase)) /*!< Record header. */
+#define PI_TRACE_RECORD_SIZE 4 /*!< Record size in words. */
+
+/** \enum pi_trace_type_e
+ * \brief Traced activities.
+ */
+typedef enum {
+  PI_TRACE_CL_TASK  = 0, /*!< Cluster task. The argument is the number of
+    cores of the task. */
+  PI_TRACE_CL_FORK  = 1, /*!< Team fork. The argument is the number of cores
+    of the team. */
+  PI_TRACE_CL_DMA   = 2, /*!< Cluster DMA transfer. The argument is the size
+    in bytes. */
+  PI_TRACE_UDMA     = 3, /*!< Peripheral transfer. The argument is
+    (channel << 24) | size, the channel being the uDMA channel ID. */
+  PI_TRACE_EVENT_CB = 4, /*!< Event kernel callback. The argument is the
+    callback function address. */
+  PI_TRACE_USER     = 5  /*!< User event. */
+} pi_trace_type_e;
+
+/** \enum pi_trace_phase_e
+ * \brief Event phase.
+ */
+typedef enum {
+  PI_TRACE_PHASE_BEGIN   = 0, /*!< Beginning of an activity. */
+  PI_TRACE_PHASE_END     = 1, /*!< End of an activity. */
+  PI_TRACE_PHASE_INSTANT = 2  /*!< Event without duration. */
+} pi_trace_phase_e;
+
+typedef int (*pi_trace_write_t)(const void *, uint32_t);
+
+// Mask of traced activities. This global variable must be implemented by PMSIS implementation.
+extern uint32_t pi_trace_mask; // Must be initialized at 0, i.e. nothing is traced.
+
+/**
+ * @brief Select the traced activities
+ *
+ * @param mask Bitfield of activities, e.g. (1 << PI_TRACE_CL_TASK) |
+ *   (1 << PI_TRACE_CL_DMA). 0 stops the trace.
+ *
+ * @return the previous mask.
+ */
+static inline uint32_t pi_trace_enable(uint32_t mask)
+{
+    uint32_t old = pi_trace_mask;
+    pi_trace_mask = mask;
+    return old;
+}
+
+/**
+ * @brief Send the content of all trace rings
+ *
+ * This must be called from the fabric controller, for example at the end of
+ * the traced section or regularly from an idle task, to empty the rings.
+ *
+ * @param write Function used for output. It receives a buffer and its size in
+ *   bytes.
+ *
+ * @return the number of records sent.
+ */
+int pi_trace_flush(pi_trace_write_t write);
+
+/**
+ * @brief Return the frequency of the trace timestamps
+ *
+ * This must be given to the host tool to convert the timestamps.
+ *
+ * @return the frequency in Hz.
+ */
+uint32_t pi_trace_timestamp_freq(void);
+
+#ifdef PI_TRACE
+
+// Must be implemented by PMSIS implementation: return the ring of the calling core.
+static inline pi_ring_t *pi_trace_ring(void);
+
+// Must be implemented by PMSIS implementation: return a free-running timestamp
+// from a time base shared by the fabric controller and the cluster.
+static inline uint32_t pi_trace_timestamp(void);
+
+/**
+ * @brief Record a trace event
+ *
+ * This function is not intended to be used directly. Instead, use the
+ * PI_TRACE_* macros, which are removed when PI_TRACE is not defined.
+ */
+static inline void pi_trace_record(pi_trace_type_e type, pi_trace_phase_e phase,
+                                   uint32_t id, uint32_t arg)
+{
+    if (!(pi_trace_mask & (1 << type)))
+        return;
+
+    pi_ring_t *ring = pi_trace_ring();
+    uint32_t head;
+
+    if (pi_ring_reserve(ring, PI_TRACE_RECORD_SIZE, &head))
+        return;
+
+    pi_ring_push(ring, &head, PI_TRACE_RECORD(type, phase));
+    pi_ring_push(ring, &head, pi_trace_timestamp());
+    pi_ring_push(ring, &head, id);
+    pi_ring_push(ring, &head, arg);
+
+    pi_ring_commit(ring, head);
+}
+
+#define PI_TRACE_BEGIN(type, id, arg) \
+    pi_trace_record(type, PI_TRACE_PHASE_BEGIN, (uint32_t)(uintptr_t)(id), (uint32_t)(uintptr_t)(arg))
+#define PI_TRACE_END(type, id, arg) \
+    pi_trace_record(type, PI_TRACE_PHASE_END, (uint32_t)(uintptr_t)(id), (uint32_t)(uintptr_t)(arg))
+#define PI_TRACE_INSTANT(type, id, arg) \
+    pi_trace_record(type, PI_TRACE_PHASE_INSTANT, (uint32_t)(uintptr_t)(id), (uint32_t)(uintptr_t)(arg))
+
+#else // PI_TRACE
+
+#define PI_TRACE_BEGIN(type, id, arg) ((void)0)
+#define PI_TRACE_END(type, id, arg) ((void)0)
+#define PI_TRACE_INSTANT(type, id, arg) ((void)0)
+
+#endif // PI_TRACE
+
+// The name must be a string literal or another constant string, as the host
+// tool reads it from the ELF file
+#define PI_TRACE_USER_BEGIN(name) PI_TRACE_BEGIN(PI_TRACE_USER, name, 0)
+#define PI_TRACE_USER_END(name) PI_TRACE_END(PI_TRACE_USER, name, 0)
+#define PI_TRACE_USER_INSTANT(name, arg) PI_TRACE_INSTANT(PI_TRACE_USER, name, arg)
+
+//!@}
+
+/**
+ * @}
+ */
+
+#endif  /* __PMSIS_RTOS_PI_TRACE_H__ */
@@ -29,5 +29,7 @@
 #include "pmsis/rtos/os_frontend_api/pmsis_time.h"
 #include "pmsis/rtos/event_kernel/event_kernel.h"
 #include "pmsis/rtos/pi_log.h"
+#include "pmsis/rtos/pi_profile.h"
+#include "pmsis/rtos/pi_trace.h"
 
 #endif  /* __PMSIS_RTOS_RTOS_H__ */
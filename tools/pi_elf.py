@@ -0,0 +1,104 @@
+#
+# Copyright (C) 2020 GreenWaves Technologies
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Minimal ELF reader used by the PMSIS host tools.
+
+Only the section headers are parsed, which is enough to read the constant
+strings referenced by address in the binary dumps produced on the target.
+
+Sections which are not allocated, e.g. placed with (INFO) in the linker
+script so that they are not loaded, have address 0 and their strings are
+referenced by offset. They are only searched when their name is given.
+"""
+
+import struct
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+
+class ElfSection(object):
+
+    def __init__(self, name, addr, data, alloc):
+        self.name = name
+        self.addr = addr
+        self.data = data
+        self.alloc = alloc
+
+    def contains(self, addr):
+        return self.addr <= addr < self.addr + len(self.data)
+
+
+class Elf(object):
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.raw = f.read()
+
+        if self.raw[0:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+
+        is_64 = self.raw[4] == 2
+        self.endian = '<' if self.raw[5] == 1 else '>'
+
+        if is_64:
+            shoff, = struct.unpack_from(self.endian + 'Q', self.raw, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + 'HHH', self.raw, 0x3A)
+            shdr = self.endian + 'IIQQQQIIQQ'
+        else:
+            shoff, = struct.unpack_from(self.endian + 'I', self.raw, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + 'HHH', self.raw, 0x2E)
+            shdr = self.endian + 'IIIIIIIIII'
+
+        headers = [struct.unpack_from(shdr, self.raw, shoff + i * shentsize) for i in range(shnum)]
+
+        strtab = headers[shstrndx]
+        strtab_data = self.raw[strtab[4]:strtab[4] + strtab[5]]
+
+        self.sections = []
+        for name, sh_type, flags, addr, offset, size in [h[0:6] for h in headers]:
+            if sh_type == SHT_NOBITS:
+                continue
+            alloc = (flags & SHF_ALLOC) != 0
+            if alloc and addr == 0:
+                continue
+            name = strtab_data[name:strtab_data.index(b'\0', name)].decode()
+            self.sections.append(ElfSection(name, addr, self.raw[offset:offset + size], alloc))
+
+    def section(self, name):
+        for section in self.sections:
+            if section.name == name:
+                return section
+        return None
+
+    def string_at(self, addr, section_name=None):
+        """Return the NUL-terminated string located at addr, or None.
+
+        If section_name is given, only this section is searched, whether it is
+        allocated or not. Otherwise all the allocated sections are searched.
+        """
+        for section in self.sections:
+            if section_name is not None and section.name != section_name:
+                continue
+            if section_name is None and not section.alloc:
+                continue
+            if section.contains(addr):
+                start = addr - section.addr
+                end = section.data.find(b'\0', start)
+                if end == -1:
+                    end = len(section.data)
+                return section.data[start:end].decode('utf-8', 'replace')
+        return None
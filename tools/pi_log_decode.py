@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Decode the binary stream produced by the PMSIS deferred log.
+
+The record format is described in include/pmsis/rtos/pi_log.h. The format
+strings and the constant strings given as %s arguments are read from the ELF
+file of the application.
+"""
+
+import argparse
+import re
+import sys
+
+from pi_elf import Elf
+from pi_stream import chunks, read_input
+
+MAGIC = 0x474f4c50
+RECORD_MASK = 0xFF000000
+RECORD_MARK = 0xA5000000
+
+FORMAT_SECTION = '.pi_log_fmt'
+
+LEVELS = {1: 'E', 2: 'W', 3: 'I', 4: 'D', 5: 'T'}
+
+FORMAT_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcspnfFeEgGaA%])')
+
+
+def to_signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def format_message(elf, fmt, args):
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, length, conv = match.groups()
+        if conv == '%':
+            return '%'
+        if conv == 'n':
+            return ''
+        # Each * takes its value from the arguments, before the converted one
+        if width == '*':
+            width = str(to_signed(args.pop(0) if args else 0))
+        if precision == '*':
+            precision = to_signed(args.pop(0) if args else 0)
+            precision = str(precision) if precision >= 0 else None
+        value = args.pop(0) if args else 0
+        spec = '%' + flags + (width or '') + ('.' + precision if precision else '')
+        if conv in 'di':
+            return (spec + 'd') % to_signed(value)
+        if conv == 'u':
+            return (spec + 'd') % value
+        if conv == 'p':
+            return '0x%08x' % value
+        if conv == 'c':
+            return (spec + 'c') % chr(value & 0xFF)
+        if conv in 'fFeEgGaA':
+            # Rejected when recording, only reached with a mismatched argument
+            return '<float 0x%08x>' % value
+        if conv == 's':
+            string = elf.string_at(value)
+            return (spec + 's') % (string if string is not None else '<0x%08x>' % value)
+        return (spec + conv) % value
+
+    return FORMAT_RE.sub(convert, fmt)
+
+
+def decode(elf, words, out):
+    for chunk in chunks(words, MAGIC):
+        cluster_id = chunk.cluster_id
+        core_id = chunk.core_id
+        records = chunk.words
+
+        if chunk.dropped:
+            out.write('W [%d:%d] log: %d records dropped\n' % (cluster_id, core_id, chunk.dropped))
+
+        index = 0
+        while index + 3 <= len(records):
+            header, fmt_addr, timestamp = records[index:index + 3]
+            if header & RECORD_MASK != RECORD_MARK:
+                out.write('W [%d:%d] log: corrupted record\n' % (cluster_id, core_id))
+                break
+
+            level = (header >> 8) & 0xFF
+            nb_args = header & 0xFF
+            args = records[index + 3:index + 3 + nb_args]
+            index += 3 + nb_args
+
+            fmt = elf.string_at(fmt_addr, FORMAT_SECTION)
+            if fmt is None:
+                message = '<unknown format 0x%08x> %s' % (fmt_addr, ' '.join('0x%x' % arg for arg in args))
+            else:
+                message = format_message(elf, fmt, args)
+
+            out.write('%s [%d:%d] %10d %s\n' % (LEVELS.get(level, '?'), cluster_id, core_id, timestamp, message))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode PMSIS deferred log stream')
+    parser.add_argument('elf', help='ELF file of the application which produced the log')
+    parser.add_argument('input', nargs='?', help='Binary log stream, standard input if not specified')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+
+    words = read_input(args.input, sys.stdin)
+
+    decode(elf, words, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,73 @@
+#
+# Copyright (C) 2020 GreenWaves Technologies
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Parser of the binary streams produced by the PMSIS record rings.
+
+The stream format is described in include/pmsis/rtos/pi_ring.h. It is used
+by the deferred log and the activity trace, which only differ by their magic
+number and their record format.
+"""
+
+import struct
+
+CHUNK_HEADER_SIZE = 4
+CHUNK_FC = 1 << 15
+
+
+class Chunk(object):
+
+    def __init__(self, cluster_id, core_id, is_fc, dropped, words):
+        self.cluster_id = cluster_id
+        self.core_id = core_id
+        self.is_fc = is_fc
+        self.dropped = dropped
+        self.words = words
+
+
+def read_words(stream):
+    data = stream.read()
+    nb_words = len(data) // 4
+    return list(struct.unpack('<%dI' % nb_words, data[:nb_words * 4]))
+
+
+def read_input(path, stdin):
+    """Return the words of the file at path, or of stdin if path is None."""
+    if path is None:
+        return read_words(stdin.buffer)
+    with open(path, 'rb') as stream:
+        return read_words(stream)
+
+
+def chunks(words, magic):
+    """Yield the chunks of the stream starting with magic."""
+    index = 0
+    while index < len(words):
+        if words[index] != magic:
+            # Resynchronize on the next chunk, e.g. after a truncated capture
+            index += 1
+            continue
+
+        if index + CHUNK_HEADER_SIZE > len(words):
+            break
+
+        core_info, nb_words, dropped = words[index + 1:index + CHUNK_HEADER_SIZE]
+        index += CHUNK_HEADER_SIZE
+        end = min(index + nb_words, len(words))
+
+        yield Chunk(core_info >> 16, core_info & (CHUNK_FC - 1), (core_info & CHUNK_FC) != 0,
+                    dropped, words[index:end])
+
+        index = end
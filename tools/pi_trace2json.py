@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Convert the binary stream produced by the PMSIS activity trace to JSON.
+
+The record format is described in include/pmsis/rtos/pi_trace.h. The output
+uses the Chrome trace event format, which can be opened with chrome://tracing
+or https://ui.perfetto.dev.
+
+Activities which belong to a core (team forks, event callbacks and user
+events) are shown as slices on the track of this core. Activities which can
+overlap on the same core (cluster tasks, cluster DMA and peripheral
+transfers) are shown as asynchronous slices on their own tracks.
+"""
+
+import argparse
+import json
+import sys
+
+from pi_elf import Elf
+from pi_stream import chunks, read_input
+
+MAGIC = 0x43525450
+RECORD_MASK = 0xFF000000
+RECORD_MARK = 0xA6000000
+RECORD_SIZE = 4
+
+CL_TASK, CL_FORK, CL_DMA, UDMA, EVENT_CB, USER = range(6)
+BEGIN, END, INSTANT = range(3)
+
+TYPE_NAMES = {
+    CL_TASK: 'cluster task',
+    CL_FORK: 'team fork',
+    CL_DMA: 'cluster DMA',
+    UDMA: 'uDMA',
+    EVENT_CB: 'event callback',
+    USER: 'user',
+}
+
+ASYNC_TYPES = (CL_TASK, CL_DMA, UDMA)
+
+
+def process_name(chunk):
+    if chunk.is_fc:
+        return 'fabric controller'
+    return 'cluster %d' % chunk.cluster_id
+
+
+class Converter(object):
+
+    def __init__(self, elf, freq):
+        self.elf = elf
+        self.us_per_tick = 1000000.0 / freq
+        self.events = []
+        self.threads = set()
+        self.last_timestamp = {}
+        self.wraps = {}
+
+    def timestamp(self, core, value):
+        # Timestamps are 32 bits free-running counters, unwrap them per core
+        last = self.last_timestamp.get(core)
+        if last is not None and value < last and last - value > 0x80000000:
+            self.wraps[core] = self.wraps.get(core, 0) + 1
+        self.last_timestamp[core] = value
+        return (value + (self.wraps.get(core, 0) << 32)) * self.us_per_tick
+
+    def name(self, rec_type, rec_id, arg):
+        if rec_type == USER:
+            name = self.elf.string_at(rec_id) if self.elf is not None else None
+            return name if name is not None else 'user 0x%08x' % rec_id
+        if rec_type == UDMA:
+            return 'uDMA channel %d' % (arg >> 24)
+        return TYPE_NAMES.get(rec_type, 'type %d' % rec_type)
+
+    def record(self, chunk, rec_type, phase, timestamp, rec_id, arg):
+        pid = process_name(chunk)
+        core_id = chunk.core_id
+        ts = self.timestamp((chunk.cluster_id, core_id), timestamp)
+        name = self.name(rec_type, rec_id, arg)
+        cat = TYPE_NAMES.get(rec_type, 'unknown')
+
+        if rec_type in ASYNC_TYPES and phase != INSTANT:
+            event = {
+                'name': name, 'cat': cat, 'ph': 'b' if phase == BEGIN else 'e',
+                'id': '0x%08x' % rec_id, 'pid': cat, 'tid': 0, 'ts': ts,
+            }
+        else:
+            tid = 'core %d' % core_id
+            self.threads.add((pid, tid))
+            event = {
+                'name': name, 'cat': cat, 'pid': pid, 'tid': tid, 'ts': ts,
+                'ph': {BEGIN: 'B', END: 'E', INSTANT: 'i'}.get(phase, 'i'),
+            }
+            if phase == INSTANT:
+                event['s'] = 't'
+
+        if phase != END or rec_type != USER:
+            event['args'] = {'id': '0x%08x' % rec_id, 'arg': arg}
+
+        self.events.append(event)
+
+    def convert(self, words):
+        for chunk in chunks(words, MAGIC):
+            core_id = chunk.core_id
+
+            if chunk.dropped:
+                sys.stderr.write('%s core %d: %d records dropped\n' % (process_name(chunk), core_id, chunk.dropped))
+
+            for index in range(0, len(chunk.words) - RECORD_SIZE + 1, RECORD_SIZE):
+                header, timestamp, rec_id, arg = chunk.words[index:index + RECORD_SIZE]
+                if header & RECORD_MASK != RECORD_MARK:
+                    sys.stderr.write('%s core %d: corrupted record\n' % (process_name(chunk), core_id))
+                    break
+                self.record(chunk, (header >> 8) & 0xFF, header & 0xFF, timestamp, rec_id, arg)
+
+        # The rings are dumped one after the other, viewers expect sorted events
+        self.events.sort(key=lambda event: event['ts'])
+
+        for pid, tid in sorted(self.threads):
+            self.events.append({'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': tid, 'args': {'name': tid}})
+
+        return {'traceEvents': self.events, 'displayTimeUnit': 'ns'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert PMSIS activity trace to Chrome trace JSON')
+    parser.add_argument('input', nargs='?', help='Binary trace stream, standard input if not specified')
+    parser.add_argument('--elf', help='ELF file of the application, used to get the names of user events')
+    parser.add_argument('--freq', type=int, default=1000000, help='Frequency in Hz of the timestamps, as returned by pi_trace_timestamp_freq (default: 1000000)')
+    parser.add_argument('--output', '-o', help='Output JSON file, standard output if not specified')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf) if args.elf is not None else None
+
+    words = read_input(args.input, sys.stdin)
+
+    trace = Converter(elf, args.freq).convert(words)
+
+    if args.output is None:
+        json.dump(trace, sys.stdout, indent=1)
+    else:
+        with open(args.output, 'w') as out:
+            json.dump(trace, out, indent=1)
+
+
+if __name__ == '__main__':
+    main()